@@ -17,6 +17,7 @@
  *==========================================================*/
 #include "app_config.h"
 #include "ssi_comms.h"
+#include "crc16.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -111,19 +112,18 @@ uint8_t ssi_payload_checksum_get(uint8_t* p_data, uint16_t len)
     return crc8;
 }
 
-void ssiv2_publish_sensor_data(uint8_t channel, uint8_t* buffer, int size)
+/*
+ * Fill in the SSI v2 header of a packet of sensor data, size bytes at buffer
+ * followed by size2 bytes at buffer2, and the checksum that follows it, for
+ * the next sequence number of channel
+ */
+static void ssiv2_frame_build(uint8_t channel, const uint8_t* buffer, int size, const uint8_t* buffer2, int size2,
+                              uint8_t ssiv2header[SSI_HEADER_SIZE], uint8_t checksum[SSI_CHECKSUM_SIZE])
 {
-    if (p_ssi_interface->initialized == false)
-    {
-        return;
-    }
-    uint8_t ssiv2header[SSI_HEADER_SIZE];
-    memset(ssiv2header, 0, SSI_HEADER_SIZE);
     uint8_t  sync   = SSI_SYNC_DATA;
     uint8_t  rsvd   = 0;
-    uint16_t u16len = (size + 6);
-    uint32_t seqnum = ssi_seqnum_update(channel);
-    uint8_t  crc8   = 0;
+    uint16_t u16len = (size + size2 + 6);
+    uint32_t seqnum = ssi_seqnum_get(channel) + 1;
 
     ssiv2header[0] = sync;
     ssiv2header[1] = (u16len >> 0) & 0xff;
@@ -135,28 +135,139 @@ void ssiv2_publish_sensor_data(uint8_t channel, uint8_t* buffer, int size)
     ssiv2header[7] = (seqnum >> 16) & 0xff;
     ssiv2header[8] = (seqnum >> 24) & 0xff;
 
+#if (SSI_JSON_CONFIG_VERSION >= 3)
+    // CRC-16 over everything after the sync byte, run on from the header into
+    // the sensor data so each byte is visited once
+    uint16_t crc16 = crc16_update(CRC16_INIT, ssiv2header + 1, SSI_HEADER_SIZE - 1);
+    crc16 = crc16_update(crc16, buffer, size);
+    crc16 = crc16_update(crc16, buffer2, size2);
+    checksum[0] = (crc16 >> 0) & 0xff;
+    checksum[1] = (crc16 >> 8) & 0xff;
+#else
     // compute 8-bit checksum
-    crc8 = crc8 ^ ssi_payload_checksum_get(ssiv2header + 3, SSI_HEADER_SIZE - 3);
-    crc8 = crc8 ^ ssi_payload_checksum_get(buffer, size);
+    checksum[0] = ssi_payload_checksum_get(ssiv2header + 3, SSI_HEADER_SIZE - 3);
+    checksum[0] ^= ssi_payload_checksum_get((uint8_t*) buffer, size);
+    if (size2 > 0)
+    {
+        checksum[0] ^= ssi_payload_checksum_get((uint8_t*) buffer2, size2);
+    }
+#endif
+}
+
+/*
+ * Publish functions return the number of bytes queued, or 0 when the packet
+ * could not be queued and should be retried later. With ssi_writev the sensor
+ * data is sent in place and must not change until the write has completed.
+ */
+int ssiv2_publish_sensor_data(uint8_t channel, uint8_t* buffer, int size)
+{
+    return ssiv2_publish_sensor_data_split(channel, buffer, size, NULL, 0);
+}
 
-    // Send SSI v2 header information
-    p_ssi_interface->ssi_write(ssiv2header, SSI_HEADER_SIZE);
+/*
+ * As ssiv2_publish_sensor_data, for sensor data in two parts, such as a packet
+ * that wraps around the end of a ring buffer; size2 may be 0
+ */
+int ssiv2_publish_sensor_data_split(uint8_t channel, uint8_t* buffer, int size, uint8_t* buffer2, int size2)
+{
+    if (p_ssi_interface->initialized == false)
+    {
+        return 0;
+    }
+    uint8_t ssiv2header[SSI_HEADER_SIZE];
+    uint8_t checksum[SSI_CHECKSUM_SIZE];
 
-    // Send sensor data
-    p_ssi_interface->ssi_write(buffer, size);
+    ssiv2_frame_build(channel, buffer, size, buffer2, size2, ssiv2header, checksum);
 
-    // Add 8-bit checksum
-    p_ssi_interface->ssi_write(&crc8, 1);
+    if (p_ssi_interface->ssi_writev != NULL)
+    {
+        // Queue header, sensor data and checksum as one packet
+        uart_iovec_t iov[4] = {
+            { ssiv2header, SSI_HEADER_SIZE, true },
+            { buffer, size, false },
+            { buffer2, size2, false },
+            { checksum, SSI_CHECKSUM_SIZE, true }
+        };
+        int iovcnt = 4;
+        if (size2 == 0)
+        {
+            iov[2] = iov[3];
+            iovcnt = 3;
+        }
+        if (p_ssi_interface->ssi_writev(iov, iovcnt) == 0)
+        {
+            return 0;
+        }
+    }
+    else
+    {
+        // Send SSI v2 header information
+        p_ssi_interface->ssi_write(ssiv2header, SSI_HEADER_SIZE);
+
+        // Send sensor data
+        p_ssi_interface->ssi_write(buffer, size);
+        if (size2 > 0)
+        {
+            p_ssi_interface->ssi_write(buffer2, size2);
+        }
+
+        // Add checksum
+        p_ssi_interface->ssi_write(checksum, SSI_CHECKSUM_SIZE);
+    }
+
+    ssi_seqnum_update(channel);
+    return SSI_HEADER_SIZE + size + size2 + SSI_CHECKSUM_SIZE;
 }
 
+/*
+ * As ssiv2_publish_sensor_data, but the packet is copied out with a single
+ * ssi_write so buffer is free again on return (size up to SSI_COPY_MAX_SIZE)
+ */
+int ssiv2_publish_sensor_data_copy(uint8_t channel, const uint8_t* buffer, int size)
+{
+    uint8_t packet[SSI_HEADER_SIZE + SSI_COPY_MAX_SIZE + SSI_CHECKSUM_SIZE];
 
-void ssiv1_publish_sensor_data(uint8_t* buffer, int size)
+    if (p_ssi_interface->initialized == false || size > SSI_COPY_MAX_SIZE)
+    {
+        return 0;
+    }
+
+    ssiv2_frame_build(channel, buffer, size, NULL, 0, packet, packet + SSI_HEADER_SIZE + size);
+    memcpy(packet + SSI_HEADER_SIZE, buffer, size);
+    if (p_ssi_interface->ssi_write(packet, SSI_HEADER_SIZE + size + SSI_CHECKSUM_SIZE) == 0)
+    {
+        return 0;
+    }
+
+    ssi_seqnum_update(channel);
+    return SSI_HEADER_SIZE + size + SSI_CHECKSUM_SIZE;
+}
+
+
+int ssiv1_publish_sensor_data(uint8_t* buffer, int size)
+{
+    return ssiv1_publish_sensor_data_split(buffer, size, NULL, 0);
+}
+
+int ssiv1_publish_sensor_data_split(uint8_t* buffer, int size, uint8_t* buffer2, int size2)
 {
     if (p_ssi_interface->initialized == false)
     {
-        return;
+        return 0;
+    }
+    if (p_ssi_interface->ssi_writev != NULL)
+    {
+        const uart_iovec_t iov[2] = {
+            { buffer, size, false },
+            { buffer2, size2, false }
+        };
+        return p_ssi_interface->ssi_writev(iov, (size2 > 0) ? 2 : 1);
+    }
+    if (size2 > 0)
+    {
+        return p_ssi_interface->ssi_write(buffer, size) + p_ssi_interface->ssi_write(buffer2, size2);
     }
-    p_ssi_interface->ssi_write(buffer, size);
+    return p_ssi_interface->ssi_write(buffer, size);
 }
 //#pragma GCC diagnostic pop
 
@@ -23,11 +23,17 @@
 #include <stdbool.h>
 #include <stddef.h>
 #ifndef SSI_JSON_CONFIG_VERSION
-#define SSI_JSON_CONFIG_VERSION    (1)     /* 2 => Use enhance SSI protocol, 1 => use original SSI protocol */
+#define SSI_JSON_CONFIG_VERSION    (1)     /* 3 => SSI v2 with CRC-16, 2 => Use enhance SSI protocol, 1 => use original SSI protocol */
 #endif //SSI_JSON_CONFIG_VERSION
 #define SSI_SYNC_DATA              (0xFF)
 #define SSI_HEADER_SIZE            (9)     ///< SSI v2 header size in bytes
+#if (SSI_JSON_CONFIG_VERSION >= 3)
+#define SSI_CHECKSUM_SIZE          (2)     ///< CRC-16 of length through payload, little endian
+#else
+#define SSI_CHECKSUM_SIZE          (1)     ///< XOR of reserved through payload
+#endif
 #define SSI_MAX_CHANNELS           (4)
+#define SSI_COPY_MAX_SIZE          (128)   ///< largest packet ssiv2_publish_sensor_data_copy sends
 #define SSI_CHANNEL_DEFAULT        (0)
 
 #define CONNECT_STRING "connect"
@@ -37,11 +43,13 @@
 #define TOTAL_CHARS 11
 
 typedef size_t (*uart_rw)(uint8_t*, const size_t);
+typedef size_t (*uart_rwv)(const uart_iovec_t*, const int);
 
 typedef struct
 {
     uart_rw ssi_read;
     uart_rw ssi_write;
+    uart_rwv ssi_writev;    ///< optional, queues a whole packet in one call
     bool initialized;
     volatile bool connected;
 } ssi_io_funcs_t;
@@ -57,6 +65,9 @@ uint32_t ssi_seqnum_update(uint8_t channel);
 uint32_t ssi_seqnum_get(uint8_t channel);
 uint8_t ssi_payload_checksum_get(uint8_t *p_data, uint16_t len);
 
-void ssiv2_publish_sensor_data(uint8_t channel, uint8_t* p_source, int ilen);
-void ssiv1_publish_sensor_data(uint8_t* buffer, int size);
+int ssiv2_publish_sensor_data(uint8_t channel, uint8_t* p_source, int ilen);
+int ssiv2_publish_sensor_data_split(uint8_t channel, uint8_t* p_source, int ilen, uint8_t* p_source2, int ilen2);
+int ssiv2_publish_sensor_data_copy(uint8_t channel, const uint8_t* p_source, int ilen);
+int ssiv1_publish_sensor_data(uint8_t* buffer, int size);
+int ssiv1_publish_sensor_data_split(uint8_t* buffer, int size, uint8_t* buffer2, int size2);
 #endif /* SSI_COMMS_H_ */
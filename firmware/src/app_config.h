@@ -52,6 +52,12 @@
 // Dump data to uart in form suitable for SensiMLs Data Capture Lab (simple stream format)
 #define DATA_STREAMER_FORMAT_SMLSS      3
 
+// Dump data to uart losslessly compressed, see deltacodec.h and tools/deltacodec.py
+#define DATA_STREAMER_FORMAT_COMPRESSED 4
+
+// Dump data to uart as COBS framed binary packets with a CRC, see cobs.h and tools/cobs_decode.py
+#define DATA_STREAMER_FORMAT_COBS       5
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: User configurable application level parameters
@@ -69,7 +75,7 @@
 // For ICM42688:
 //  - set SNSR_SAMPLE_RATE to one of: 25, 50, 100, 200, 500, 1000, 2000, 4000, 8000, 16000
 // !NB! Increasing the sample rate above 500Hz (this may be lower for non MDV formats)
-// with all 6 axes may cause buffer overruns
+// with all 6 axes may cause buffer overruns unless SNSR_USE_FIFO is enabled
 //  - Change at your own risk!
 #define SNSR_SAMPLE_RATE        100
 
@@ -86,6 +92,56 @@
 #define SNSR_USE_ACCEL          true
 #define SNSR_USE_GYRO           true
 
+// Append a timestamp column to each sample: the sample time in microseconds as
+// an unsigned 32 bit value, split little endian across SNSR_TIMESTAMP_WORDS
+// words of SNSR_DATA_TYPE (so binary formats carry a plain uint32 after the
+// axes). Taken from the IMU's own clock where available, otherwise from the
+// MCU microsecond timer, captured in hardware on the data ready edge
+#ifndef SNSR_USE_TIMESTAMP
+#define SNSR_USE_TIMESTAMP      false
+#endif
+
+// Use the IMU FIFO for acquisition: samples are drained in a single burst on
+// each FIFO watermark interrupt rather than with one register read per
+// data-ready interrupt. Recommended for sample rates above 500Hz
+#ifndef SNSR_USE_FIFO
+#define SNSR_USE_FIFO           false
+#endif
+
+// Clock the ICM42688 from the MCU (RTC mode) so its sample rate is locked to
+// the MCU clock instead of drifting with the IMU's internal oscillator. Needs
+// the CLKIN_PIN output below wired to the IMU's CLKIN (pin 9, INT2/FSYNC).
+// Sample rates then scale with the CLKIN frequency (-107ppm from nominal)
+#ifndef SNSR_USE_CLKIN
+#define SNSR_USE_CLKIN          false
+#endif
+
+// Keep streaming through a full sample buffer: new samples that find no room
+// are dropped and counted, and the stream carries a gap record with the count
+// where they would have been. Otherwise an overrun stops the stream for 5s
+// and restarts it with an empty buffer
+#ifndef SNSR_OVERRUN_CONTINUOUS
+#define SNSR_OVERRUN_CONTINUOUS false
+#endif
+
+// Time the ASCII line formatter at startup and print the CPU cycles it takes
+// per frame, next to the snprintf based formatter it replaced
+#ifndef ASCII_BENCHMARK
+#define ASCII_BENCHMARK         false
+#endif
+
+// Keep occupancy telemetry of the sample and UART RX buffers (high-water mark,
+// fill level histogram, overrun count, time since last full) and report it
+// when the host sends "status"; useful for sizing SNSR_BUF_LEN, but it adds
+// work to every sample interrupt
+#ifndef RINGBUFFER_STATS
+#define RINGBUFFER_STATS        false
+#endif
+
+// Number of samples collected by the IMU FIFO before an interrupt is raised
+// (must be less than SNSR_BUF_LEN)
+#define SNSR_FIFO_WATERMARK     16
+
 // Size of sensor buffer in samples (must be power of 2)
 #define SNSR_BUF_LEN            128
 
@@ -95,12 +151,49 @@
 // Frame header byte for MPLAB DV
 #define MDV_START_OF_FRAME      0xA5U
 
+// Samples carried in each MPLAB DV frame (at most SNSR_BUF_LEN);
+// sending several per frame spends less of the link on framing. The DV
+// workspace must match, see mplab-dv-workspaces
+#ifndef MDV_SAMPLES_PER_PACKET
+#define MDV_SAMPLES_PER_PACKET  1
+#endif
+
+// Start each MPLAB DV frame with a rolling 16 bit frame count, so frames lost
+// on the link or dropped by the firmware show up as a jump in the count
+#ifndef MDV_USE_FRAME_COUNTER
+#define MDV_USE_FRAME_COUNTER   false
+#endif
+
 // SensiML specific parameters
 #if (DATA_STREAMER_FORMAT == DATA_STREAMER_FORMAT_SMLSS)
-#define SML_MAX_CONFIG_STRLEN   256
-#define SNSR_SAMPLES_PER_PACKET 8  // must be factor of SNSR_BUF_LEN
-#define SSI_JSON_CONFIG_VERSION 2  // 2 => Use enhance SSI protocol,
+#define SML_MAX_CONFIG_STRLEN   (SSI_MULTI_CHANNEL ? 1024 : 320)
+#define SNSR_SAMPLES_PER_PACKET 8  // at most SNSR_BUF_LEN
+#ifndef SSI_JSON_CONFIG_VERSION
+#define SSI_JSON_CONFIG_VERSION 2  // 3 => Use enhanced SSI protocol with CRC-16,
+                                   // 2 => Use enhance SSI protocol,
                                    // 1 => use original SSI protocol
+#endif
+#define SSI_CRC_BENCHMARK       false  // time the CRC-16 against the XOR checksum at startup (version 3)
+// Publish the accelerometer, gyroscope, die temperature and events on SSI
+// channels 0 to 3, each at its own rate (version 2 or later). Tools that only
+// read channel 0 see the accelerometer alone
+#ifndef SSI_MULTI_CHANNEL
+#define SSI_MULTI_CHANNEL       false
+#endif
+// The gyroscope channel runs at SNSR_SAMPLE_RATE / SSI_GYRO_DECIMATION, each
+// sample the mean of SSI_GYRO_DECIMATION frames. The mean is only a crude
+// low-pass filter: motion near multiples of the channel rate still aliases in,
+// so set the sensor's own bandwidth below half the channel rate when it matters
+#define SSI_GYRO_DECIMATION     2
+#define SSI_GYRO_SAMPLES_PER_PACKET 4  // gyroscope channel samples per packet
+#define SSI_TEMP_RATE           1  // temperature channel rate in Hz
+#elif (DATA_STREAMER_FORMAT == DATA_STREAMER_FORMAT_MDV)
+#define SNSR_SAMPLES_PER_PACKET MDV_SAMPLES_PER_PACKET
+#elif (DATA_STREAMER_FORMAT == DATA_STREAMER_FORMAT_COMPRESSED)
+#define SNSR_SAMPLES_PER_PACKET 8  // at most SNSR_BUF_LEN
+#define COMPRESSED_KEYFRAME_INTERVAL 16  // packets from one keyframe to the next
+#elif (DATA_STREAMER_FORMAT == DATA_STREAMER_FORMAT_COBS)
+#define SNSR_SAMPLES_PER_PACKET 4  // at most SNSR_BUF_LEN
 #else
 #define SNSR_SAMPLES_PER_PACKET 1
 #endif
@@ -109,6 +202,17 @@
 #define TICK_RATE_FAST          100
 #define TICK_RATE_SLOW          500
 
+// UART baud rate at power-on, and the range the host may switch to with the
+// "baud <rate>" command. A new rate must be confirmed by the host within
+// UART_BAUD_CONFIRM_MS, otherwise the link falls back to the previous rate
+#define UART_BAUD_DEFAULT       115200
+#define UART_BAUD_MIN           9600
+#define UART_BAUD_MAX           3000000     // SERCOM clock / 16x oversampling
+#define UART_BAUD_CONFIRM_MS    1000
+
+// Share of the UART bandwidth, in percent, a stream may use to be admitted
+#define UART_LINK_MAX_LOAD      90
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Defines derived from user config parameters
@@ -116,6 +220,16 @@
 // *****************************************************************************
 #define SNSR_NUM_AXES   (3*SNSR_USE_ACCEL + 3*SNSR_USE_GYRO)
 
+/* Number of SNSR_DATA_TYPE words used to hold the timestamp column */
+#if SNSR_USE_TIMESTAMP
+#define SNSR_TIMESTAMP_WORDS    ((sizeof(uint32_t) + sizeof(SNSR_DATA_TYPE) - 1) / sizeof(SNSR_DATA_TYPE))
+#else
+#define SNSR_TIMESTAMP_WORDS    0
+#endif
+
+/* Number of SNSR_DATA_TYPE words in a sample frame */
+#define SNSR_NUM_COLUMNS    (SNSR_NUM_AXES + SNSR_TIMESTAMP_WORDS)
+
 /* Define whether multiple sensors types are being used */
 #if (SNSR_USE_ACCEL && SNSR_USE_GYRO)
     #define MULTI_SENSOR 1
@@ -123,9 +237,20 @@
     #define MULTI_SENSOR 0
 #endif
 
-// The way the buffering works the following condition must be enforced
-#if (SNSR_BUF_LEN % SNSR_SAMPLES_PER_PACKET) > 0
-#error "SNSR_SAMPLES_PER_PACKET must be a factor of SNSR_BUF_LEN"
+// A packet is sent from the buffer (in two parts when it wraps around the
+// end), so it must fit in it
+#if SNSR_SAMPLES_PER_PACKET > SNSR_BUF_LEN
+#error "SNSR_SAMPLES_PER_PACKET must be at most SNSR_BUF_LEN"
+#endif
+
+// Channels other than 0 only exist from version 2 of the interface
+#if (DATA_STREAMER_FORMAT == DATA_STREAMER_FORMAT_SMLSS) && SSI_MULTI_CHANNEL && (SSI_JSON_CONFIG_VERSION < 2)
+#error "SSI_MULTI_CHANNEL requires SSI_JSON_CONFIG_VERSION 2 or later"
+#endif
+
+// A full FIFO watermark worth of samples must fit in the sample buffer
+#if SNSR_USE_FIFO && (SNSR_FIFO_WATERMARK >= SNSR_BUF_LEN)
+#error "SNSR_FIFO_WATERMARK must be less than SNSR_BUF_LEN"
 #endif
 
 // Provide the functions needed by sensor module
@@ -174,28 +299,60 @@
 #define UART_RX_DATA        SERCOM5_REGS->USART_INT.SERCOM_DATA
 #define UART_IsRxReady      SERCOM5_USART_ReceiverIsReady
 #define UART_RXC_Enable()   { SERCOM5_REGS->USART_INT.SERCOM_INTENSET |= (uint8_t)(SERCOM_USART_INT_INTENSET_RXC_Msk); }
+#define UART_TxIsBusy       SERCOM5_USART_DMA_IsBusy
+#define UART_TxIsComplete   SERCOM5_USART_TransmitComplete
+#define UART_SerialSetup(setup) SERCOM5_USART_SerialSetup(setup, 0)
+#define UART_WriteVCompleteCountGet SERCOM5_USART_DMA_WriteVCompleteCountGet  // vectored writes fully sent
+#define UART_TxFreeGet      SERCOM5_USART_DMA_WriteFreeBufferCountGet      // bytes the next write may queue
 
 // Device init / management
 //#define SYS_Initialize   SYS_Initialize
 //#define SYS_Tasks        SYS_Tasks
 
+// ICM42688 CLKIN reference: GCLK1 output (DFLL48M / 1465) on PA15 (GCLK_IO[1])
+#define CLKIN_SOURCE_HZ     48000000UL
+#define CLKIN_DIVIDER       1465UL
+#define CLKIN_PIN           15U
+#define CLKIN_OutputEnable() do { \
+        PORT_REGS->GROUP[0].PORT_PMUX[CLKIN_PIN >> 1] = (PORT_REGS->GROUP[0].PORT_PMUX[CLKIN_PIN >> 1] & ~PORT_PMUX_PMUXO_Msk) | PORT_PMUX_PMUXO(PERIPHERAL_FUNCTION_H); \
+        PORT_REGS->GROUP[0].PORT_PINCFG[CLKIN_PIN] |= PORT_PINCFG_PMUXEN_Msk; \
+    } while (0)
+
+// CPU cycle counter for profiling: SysTick counting down from the CPU clock
+#define CYCLES_MASK         0xFFFFFFUL
+#define CYCLES_Start()      do { SYSTICK_TimerPeriodSet(CYCLES_MASK + 1UL); SYSTICK_TimerStart(); } while (0)
+#define CYCLES_Stop         SYSTICK_TimerStop
+#define CYCLES_Get          SYSTICK_TimerCounterGet
+
 // Sensor external interrupt
 #define MIKRO_INT_CallbackRegister(cb) EIC_CallbackRegister(EIC_PIN_12, cb, (uintptr_t) NULL)
 
-// uS Timer
+// uS Timer: free running 16 bit counter at 1MHz, extended in software on overflow
+#define TC_TIMER_BITS                   16
 #define TC_TimerStart                   TC3_TimerStart
 #define TC_TimerGet_us                  TC3_Timer16bitCounterGet
+#define TC_TimerOverflowPending         TC3_TimerOverflowPending
+#define TC_TimerCaptureGet_us           TC3_Timer16bitCaptureGet    // MIKRO_INT edge routed via EVSYS
 #define TC_TimerCallbackRegister(cb)    TC3_TimerCallbackRegister(cb, (uintptr_t) NULL)
 size_t __attribute__(( unused )) UART_Read(uint8_t *ptr, const size_t nbytes);
 size_t __attribute__(( unused )) UART_Write(uint8_t *ptr, const size_t nbytes);
 
+// Span of a vectored UART write. Spans that are not copied are sent in place
+// and must not change until the write has completed
+typedef struct {
+    const uint8_t *base;
+    size_t len;
+    bool copy;
+} uart_iovec_t;
+size_t __attribute__(( unused )) UART_WriteV(const uart_iovec_t *iov, const int iovcnt);
+
 #ifdef	__cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
 typedef SNSR_DATA_TYPE snsr_data_t;
-typedef SNSR_DATA_TYPE snsr_dataframe_t[SNSR_NUM_AXES];
-typedef SNSR_DATA_TYPE snsr_datapacket_t[SNSR_NUM_AXES*SNSR_SAMPLES_PER_PACKET];
+typedef SNSR_DATA_TYPE snsr_dataframe_t[SNSR_NUM_COLUMNS];
+typedef SNSR_DATA_TYPE snsr_datapacket_t[SNSR_NUM_COLUMNS*SNSR_SAMPLES_PER_PACKET];
 
 #ifdef	__cplusplus
 }
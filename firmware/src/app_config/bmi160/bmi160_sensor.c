@@ -66,21 +66,154 @@
 #define _SNSRGYRORANGEEXPR(x) __SNSRGYRORANGEMACRO(x)
 #define _GET_IMU_GYRO_RANGE_MACRO() _SNSRGYRORANGEEXPR(SNSR_GYRO_RANGE)
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: FIFO configuration
+// *****************************************************************************
+// *****************************************************************************
+#if SNSR_USE_CLKIN
+#error "SNSR_USE_CLKIN is only supported by the ICM42688"
+#endif
+
+#if SNSR_USE_FIFO
+// Size in bytes of the BMI160 FIFO
+#define SNSR_FIFO_SIZE          1024
+
+// Size in bytes of a header-less FIFO frame holding the enabled sensors
+#define SNSR_FIFO_FRAME_SIZE    (SNSR_NUM_AXES * sizeof(int16_t))
+
+// Maximum number of frames that can be queued in the FIFO
+#define SNSR_FIFO_MAX_FRAMES    (SNSR_FIFO_SIZE / (SNSR_NUM_AXES * 2))
+
+// FIFO frame content selection
+#define SNSR_FIFO_CONFIG        ((SNSR_USE_ACCEL ? BMI160_FIFO_ACCEL : 0) | (SNSR_USE_GYRO ? BMI160_FIFO_GYRO : 0))
+
+/* Leave at least half of the FIFO as headroom for read latency */
+#if (SNSR_FIFO_WATERMARK < 1) || (SNSR_FIFO_WATERMARK > (SNSR_FIFO_MAX_FRAMES / 2))
+#error "SNSR_FIFO_WATERMARK must be between 1 and half the BMI160 FIFO capacity in samples"
+#endif
+
+static uint8_t l_fifo_data[SNSR_FIFO_MAX_FRAMES * SNSR_FIFO_FRAME_SIZE];
+static struct bmi160_fifo_frame l_fifo_frame;
+#if SNSR_USE_ACCEL
+static struct bmi160_sensor_data l_fifo_accel[SNSR_FIFO_MAX_FRAMES];
+#endif
+#if SNSR_USE_GYRO
+static struct bmi160_sensor_data l_fifo_gyro[SNSR_FIFO_MAX_FRAMES];
+#endif
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Serial comms implementation
 // *****************************************************************************
 // *****************************************************************************
-static int8_t bmi160_i2c_read (uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, uint16_t len) {
-    if(SERCOM1_I2C_WriteRead((uint16_t) dev_addr, &reg_addr, 1, data, (uint32_t) len)) {
-        while(SERCOM1_I2C_IsBusy());
-        return BMI160_OK;
-    }
-    else {
-        return BMI160_E_COM_FAIL;        
+// Transactions are queued and run back to back from the SERCOM1 interrupt
+#define SNSR_I2C_QUEUE_LEN  4   // must be power of 2
+
+typedef void (*bmi160_i2c_cb_t)(bool success, uintptr_t context);
+
+typedef struct {
+    uint8_t dev_addr;
+    uint8_t *wrdata;
+    uint32_t wrlen;
+    uint8_t *rddata;
+    uint32_t rdlen;
+    bmi160_i2c_cb_t callback;
+    uintptr_t context;
+} bmi160_i2c_xfer_t;
+
+static bmi160_i2c_xfer_t _i2c_queue_data[SNSR_I2C_QUEUE_LEN];
+static ringbuffer_t l_i2c_queue;
+static volatile bool l_i2c_active = false;
+
+static volatile bool l_i2c_sync_done = false;
+static volatile bool l_i2c_sync_success = false;
+
+// Start the transaction at the head of the queue if the bus is free; must not be
+// preempted by the SERCOM1 interrupt
+static void bmi160_i2c_start_next(void) {
+    ringbuffer_size_t rdcnt;
+    const bmi160_i2c_xfer_t *xfer;
+    bool started;
+    
+    while (!l_i2c_active) {
+        xfer = ringbuffer_get_read_buffer(&l_i2c_queue, &rdcnt);
+        if (rdcnt == 0)
+            break;
+        
+        if (xfer->rdlen)
+            started = SERCOM1_I2C_WriteRead((uint16_t) xfer->dev_addr, xfer->wrdata, xfer->wrlen, xfer->rddata, xfer->rdlen);
+        else
+            started = SERCOM1_I2C_Write((uint16_t) xfer->dev_addr, xfer->wrdata, xfer->wrlen);
+        
+        if (started) {
+            l_i2c_active = true;
+        }
+        else {
+            /* Fail the request and move on to the next one */
+            bmi160_i2c_cb_t callback = xfer->callback;
+            uintptr_t context = xfer->context;
+            ringbuffer_advance_read_index(&l_i2c_queue, 1);
+            if (callback)
+                callback(false, context);
+        }
     }
 }
 
+// Handle completion of the active transaction from the SERCOM1 interrupt
+static void bmi160_i2c_complete(uintptr_t context) {
+    ringbuffer_size_t rdcnt;
+    const bmi160_i2c_xfer_t *xfer = ringbuffer_get_read_buffer(&l_i2c_queue, &rdcnt);
+    bmi160_i2c_cb_t callback = xfer->callback;
+    uintptr_t xfer_context = xfer->context;
+    bool success = (SERCOM1_I2C_ErrorGet() == SERCOM_I2C_ERROR_NONE);
+    
+    ringbuffer_advance_read_index(&l_i2c_queue, 1);
+    l_i2c_active = false;
+    
+    /* Keep the bus busy before handing the result back */
+    bmi160_i2c_start_next();
+    
+    if (callback)
+        callback(success, xfer_context);
+}
+
+static bool bmi160_i2c_submit(const bmi160_i2c_xfer_t *xfer) {
+    bool queued;
+    bool interruptState = NVIC_INT_Disable();
+    
+    queued = (ringbuffer_write(&l_i2c_queue, xfer, 1) == 1);
+    if (queued)
+        bmi160_i2c_start_next();
+    
+    NVIC_INT_Restore(interruptState);
+    
+    return queued;
+}
+
+static void bmi160_i2c_sync_cb(bool success, uintptr_t context) {
+    l_i2c_sync_success = success;
+    l_i2c_sync_done = true;
+}
+
+// Queue a transaction and wait for it to complete
+static int8_t bmi160_i2c_transfer(uint8_t dev_addr, uint8_t *wrdata, uint32_t wrlen, uint8_t *rddata, uint32_t rdlen) {
+    bmi160_i2c_xfer_t xfer = { dev_addr, wrdata, wrlen, rddata, rdlen, bmi160_i2c_sync_cb, (uintptr_t) NULL };
+    
+    l_i2c_sync_done = false;
+    if (!bmi160_i2c_submit(&xfer))
+        return BMI160_E_COM_FAIL;
+    
+    while (!l_i2c_sync_done);
+    
+    return l_i2c_sync_success ? BMI160_OK : BMI160_E_COM_FAIL;
+}
+
+static int8_t bmi160_i2c_read (uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, uint16_t len) {
+    return bmi160_i2c_transfer(dev_addr, &reg_addr, 1, data, (uint32_t) len);
+}
+
 static int8_t bmi160_i2c_write (uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, uint16_t len) {
     static uint8_t buff [SNSR_COM_BUF_SIZE];
     
@@ -90,12 +223,7 @@ static int8_t bmi160_i2c_write (uint8_t dev_addr, uint8_t reg_addr, uint8_t *dat
     buff[0] = reg_addr;
     memcpy(&buff[1], data, len);
     
-    if (SERCOM1_I2C_Write((uint16_t) dev_addr, buff, (uint32_t) len + 1)) {
-        while(SERCOM1_I2C_IsBusy());
-        return BMI160_OK;
-    } else {
-        return BMI160_E_COM_FAIL;
-    }
+    return bmi160_i2c_transfer(dev_addr, buff, (uint32_t) len + 1, NULL, 0);
 }
 
 // *****************************************************************************
@@ -103,29 +231,210 @@ static int8_t bmi160_i2c_write (uint8_t dev_addr, uint8_t reg_addr, uint8_t *dat
 // Section: Platform generic sensor implementation functions
 // *****************************************************************************
 // *****************************************************************************
-int bmi160_sensor_read(struct sensor_device_t *sensor, snsr_data_t *ptr)
+/* Data registers hold gyro X,Y,Z followed by accel X,Y,Z, little endian; only
+ * the block covering the enabled sensors is read */
+#define SNSR_DATA_START_ADDR    (SNSR_USE_GYRO ? BMI160_GYRO_DATA_ADDR : BMI160_ACCEL_DATA_ADDR)
+#define SNSR_DATA_GYRO_OFFSET   0
+#define SNSR_DATA_ACCEL_OFFSET  (BMI160_ACCEL_DATA_ADDR - SNSR_DATA_START_ADDR)
+
+/* The 24 bit sensortime count follows the accel data registers; it ticks every
+ * 39.0625us and the data registers are updated when the count crosses a
+ * multiple of the ODR period, which is a power of 2 ticks for every rate */
+#define SNSR_SENSORTIME_ADDR    (BMI160_ACCEL_DATA_ADDR + 6)
+#define SNSR_SENSORTIME_LEN     3
+#define SNSR_SENSORTIME_MASK    0xFFFFFFU
+#define SNSR_SENSORTIME_PERIOD  (25600U / SNSR_SAMPLE_RATE)
+#define SNSR_SENSORTIME_TO_US(x) (((x) * 625U) / 16U)
+
+#if SNSR_USE_TIMESTAMP
+#define SNSR_DATA_LEN           (SNSR_SENSORTIME_ADDR + SNSR_SENSORTIME_LEN - SNSR_DATA_START_ADDR)
+#define SNSR_DATA_TIME_OFFSET   (SNSR_SENSORTIME_ADDR - SNSR_DATA_START_ADDR)
+#else
+#define SNSR_DATA_LEN           (SNSR_NUM_AXES * 2)
+#endif
+
+/* State of the sample read in flight on the I2C queue */
+static uint8_t l_snsr_data_reg = SNSR_DATA_START_ADDR;
+static uint8_t l_snsr_data[SNSR_DATA_LEN];
+static struct sensor_device_t * l_snsr_async_sensor = NULL;
+static snsr_data_t * l_snsr_async_buffer = NULL;
+static sensor_read_cb_t l_snsr_async_cb = NULL;
+
+/* Sensortime extended past its 24 bit wrap (every ~655s) */
+static uint32_t l_sensortime_last = 0;
+static uint64_t l_sensortime_ticks = 0;
+#if SNSR_USE_FIFO && SNSR_USE_TIMESTAMP
+/* Sensortime of the next frame expected out of the FIFO */
+static uint64_t l_fifo_next_ticks = 0;
+static bool l_fifo_time_valid = false;
+#endif
+
+static inline snsr_data_t bmi160_decode_sample(const uint8_t *in) {
+    return (snsr_data_t) (int16_t) ((in[1] << 8) | in[0]);
+}
+
+// Extend a sensortime reading and round it down to the sample it belongs to
+static uint64_t bmi160_sensortime_sample(uint32_t sensortime) {
+    l_sensortime_ticks += (sensortime - l_sensortime_last) & SNSR_SENSORTIME_MASK;
+    l_sensortime_last = sensortime;
+    
+    return l_sensortime_ticks & ~((uint64_t) SNSR_SENSORTIME_PERIOD - 1);
+}
+
+// Handle completion of the I2C transaction queued by bmi160_sensor_read_async
+static void bmi160_sensor_read_complete(bool success, uintptr_t context)
 {
-    /* Read bmi160 sensor data */
-    struct bmi160_sensor_data accel;
-    struct bmi160_sensor_data gyro;
-    int status;
+    struct sensor_device_t *sensor = l_snsr_async_sensor;
+    snsr_data_t *ptr = l_snsr_async_buffer;
     
-    status = bmi160_get_sensor_data(BMI160_ACCEL_SEL | BMI160_GYRO_SEL, &accel, &gyro, &sensor->device);
-    if (status != BMI160_OK)
-        return status;
+    if (!success) {
+        sensor->status = BMI160_E_COM_FAIL;
+    }
+    else {
+#if SNSR_USE_TIMESTAMP
+        const uint8_t *time = &l_snsr_data[SNSR_DATA_TIME_OFFSET];
+        uint32_t sensortime = ((uint32_t) time[2] << 16) | ((uint32_t) time[1] << 8) | time[0];
+        snsr_set_timestamp(ptr, (uint32_t) SNSR_SENSORTIME_TO_US(bmi160_sensortime_sample(sensortime)));
+#endif
+        
+        /* Convert sensor data to buffer type and write to buffer */
+#if SNSR_USE_ACCEL
+        *ptr++ = bmi160_decode_sample(&l_snsr_data[SNSR_DATA_ACCEL_OFFSET + 0]);
+        *ptr++ = bmi160_decode_sample(&l_snsr_data[SNSR_DATA_ACCEL_OFFSET + 2]);
+        *ptr++ = bmi160_decode_sample(&l_snsr_data[SNSR_DATA_ACCEL_OFFSET + 4]);
+#endif
+#if SNSR_USE_GYRO
+        *ptr++ = bmi160_decode_sample(&l_snsr_data[SNSR_DATA_GYRO_OFFSET + 0]);
+        *ptr++ = bmi160_decode_sample(&l_snsr_data[SNSR_DATA_GYRO_OFFSET + 2]);
+        *ptr++ = bmi160_decode_sample(&l_snsr_data[SNSR_DATA_GYRO_OFFSET + 4]);
+#endif
+        sensor->status = BMI160_OK;
+    }
+    
+    l_snsr_async_cb(sensor);
+}
+
+int bmi160_sensor_read_async(struct sensor_device_t *sensor, snsr_data_t *ptr, sensor_read_cb_t callback)
+{
+    bmi160_i2c_xfer_t xfer = { sensor->device.id, &l_snsr_data_reg, 1, l_snsr_data, sizeof(l_snsr_data), bmi160_sensor_read_complete, (uintptr_t) NULL };
+    
+    l_snsr_async_sensor = sensor;
+    l_snsr_async_buffer = ptr;
+    l_snsr_async_cb = callback;
+    
+    /* Set status before queuing as the completion may preempt us */
+    sensor->status = BMI160_OK;
+    
+    if (!bmi160_i2c_submit(&xfer))
+        sensor->status = BMI160_E_COM_FAIL;
+    
+    return sensor->status;
+}
+
+#if SNSR_USE_FIFO
+int bmi160_sensor_read_fifo(struct sensor_device_t *sensor, snsr_ringbuffer_t *ringbuffer, ringbuffer_size_t *dropped)
+{
+    uint8_t framecount = SNSR_FIFO_MAX_FRAMES;
+    snsr_ringbuffer_write_spans_t spans;
+    ringbuffer_size_t reserved;
+    int i;
+    
+    *dropped = 0;
     
-    /* Convert sensor data to buffer type and write to buffer */
+    /* Read the whole FIFO in one burst */
+    l_fifo_frame.length = sizeof(l_fifo_data);
+    if ((sensor->status = bmi160_get_fifo_data(&sensor->device)) != BMI160_OK)
+        return sensor->status;
+    
+    /* Decode the header-less frames */
 #if SNSR_USE_ACCEL
-    *ptr++ = (snsr_data_t) accel.x;
-    *ptr++ = (snsr_data_t) accel.y;
-    *ptr++ = (snsr_data_t) accel.z;
+    uint8_t accel_frames = SNSR_FIFO_MAX_FRAMES;
+    bmi160_extract_accel(l_fifo_accel, &accel_frames, &sensor->device);
+    framecount = accel_frames;
 #endif
 #if SNSR_USE_GYRO
-    *ptr++ = (snsr_data_t) gyro.x;
-    *ptr++ = (snsr_data_t) gyro.y;
-    *ptr++ = (snsr_data_t) gyro.z;
+    uint8_t gyro_frames = SNSR_FIFO_MAX_FRAMES;
+    bmi160_extract_gyro(l_fifo_gyro, &gyro_frames, &sensor->device);
+    if (gyro_frames < framecount)
+        framecount = gyro_frames;
+#endif
+    
+#if SNSR_USE_TIMESTAMP
+    /* Header-less frames carry no time so count them off the sensortime grid */
+    uint8_t time[SNSR_SENSORTIME_LEN];
+    uint64_t ticks;
+    
+    if ((sensor->status = bmi160_get_regs(SNSR_SENSORTIME_ADDR, time, SNSR_SENSORTIME_LEN, &sensor->device)) != BMI160_OK)
+        return sensor->status;
+    
+    /* The last frame drained is at most a few periods before this reading;
+     * resynchronize if frames were lost to a FIFO overflow */
+    ticks = bmi160_sensortime_sample(((uint32_t) time[2] << 16) | ((uint32_t) time[1] << 8) | time[0]);
+    if (framecount && (!l_fifo_time_valid
+            || (ticks - (l_fifo_next_ticks + (uint64_t) (framecount - 1) * SNSR_SENSORTIME_PERIOD)) > (uint64_t) SNSR_FIFO_WATERMARK * SNSR_SENSORTIME_PERIOD)) {
+        l_fifo_next_ticks = ticks - (uint64_t) (framecount - 1) * SNSR_SENSORTIME_PERIOD;
+        l_fifo_time_valid = true;
+    }
+#endif
+    
+    /* Convert sensor data to buffer type in place, then publish the lot at once */
+    reserved = snsr_ringbuffer_reserve_write(ringbuffer, framecount, &spans);
+    *dropped = framecount - reserved;
+    i = 0;
+    for (int s = 0; s < 2; s++) {
+        snsr_data_t *ptr = *spans.data[s];
+        
+        for (ringbuffer_size_t j = 0; j < spans.itemcount[s]; j++, i++) {
+#if SNSR_USE_ACCEL
+            *ptr++ = (snsr_data_t) l_fifo_accel[i].x;
+            *ptr++ = (snsr_data_t) l_fifo_accel[i].y;
+            *ptr++ = (snsr_data_t) l_fifo_accel[i].z;
+#endif
+#if SNSR_USE_GYRO
+            *ptr++ = (snsr_data_t) l_fifo_gyro[i].x;
+            *ptr++ = (snsr_data_t) l_fifo_gyro[i].y;
+            *ptr++ = (snsr_data_t) l_fifo_gyro[i].z;
+#endif
+#if SNSR_USE_TIMESTAMP
+            snsr_set_timestamp(ptr - SNSR_NUM_AXES, (uint32_t) SNSR_SENSORTIME_TO_US(l_fifo_next_ticks + (uint64_t) i * SNSR_SENSORTIME_PERIOD));
+            ptr += SNSR_TIMESTAMP_WORDS;
+#endif
+        }
+    }
+    snsr_ringbuffer_commit_write(ringbuffer, reserved);
+    
+#if SNSR_USE_TIMESTAMP
+    l_fifo_next_ticks += (uint64_t) framecount * SNSR_SENSORTIME_PERIOD;
 #endif
     
+    return sensor->status;
+}
+
+int bmi160_sensor_flush_fifo(struct sensor_device_t *sensor)
+{
+    sensor->status = bmi160_set_fifo_flush(&sensor->device);
+#if SNSR_USE_TIMESTAMP
+    l_fifo_time_valid = false;
+#endif
+    
+    return sensor->status;
+}
+#endif
+
+/* TEMPERATURE_0/1: 23degC at zero, 1/512 K per LSB */
+#define SNSR_TEMPERATURE_ADDR   0x20
+
+int bmi160_sensor_read_temperature(struct sensor_device_t *sensor, int16_t *centidegrees)
+{
+    uint8_t data[2];
+    int status;
+    
+    status = bmi160_get_regs(SNSR_TEMPERATURE_ADDR, data, sizeof(data), &sensor->device);
+    if (status != BMI160_OK)
+        return status;
+    
+    *centidegrees = (int16_t) (2300 + ((int32_t) (int16_t) (data[0] | (data[1] << 8)) * 100) / 512);
+    
     return status;
 }
 
@@ -139,6 +448,13 @@ int bmi160_sensor_init(struct sensor_device_t *sensor) {
     sensor->device.write = bmi160_i2c_write;
     sensor->device.delay_ms = snsr_sleep_ms;
     
+    /* Initialize the I2C transaction queue */
+    if (ringbuffer_init(&l_i2c_queue, _i2c_queue_data, sizeof(_i2c_queue_data) / sizeof(_i2c_queue_data[0]), sizeof(_i2c_queue_data[0]))) {
+        sensor->status = BMI160_E_COM_FAIL;
+        return sensor->status;
+    }
+    SERCOM1_I2C_CallbackRegister(bmi160_i2c_complete, (uintptr_t) NULL);
+    
     sensor->status = bmi160_init(&sensor->device);
     
     return sensor->status;
@@ -187,8 +503,32 @@ int bmi160_sensor_set_config(struct sensor_device_t *sensor) {
     /* Select the Interrupt channel/pin */
     int_config.int_channel = BMI160_INT_CHANNEL_1;// Interrupt channel/pin 1
 
+#if SNSR_USE_FIFO
+    /* Configure the FIFO for header-less frames of the enabled sensors */
+    l_fifo_frame.data = l_fifo_data;
+    l_fifo_frame.length = sizeof(l_fifo_data);
+    sensor->device.fifo = &l_fifo_frame;
+    
+    if ((sensor->status = bmi160_set_fifo_config(BMI160_FIFO_CONFIG_1_MASK, BMI160_DISABLE, &sensor->device)) != BMI160_OK)
+        return sensor->status;
+    
+    if ((sensor->status = bmi160_set_fifo_config(SNSR_FIFO_CONFIG, BMI160_ENABLE, &sensor->device)) != BMI160_OK)
+        return sensor->status;
+    
+    /* Watermark level is in units of 4 bytes */
+    if ((sensor->status = bmi160_set_fifo_wm((SNSR_FIFO_WATERMARK * SNSR_FIFO_FRAME_SIZE + 3) / 4, &sensor->device)) != BMI160_OK)
+        return sensor->status;
+    
+    if ((sensor->status = bmi160_set_fifo_flush(&sensor->device)) != BMI160_OK)
+        return sensor->status;
+    
+    /* Select the Interrupt type */
+    int_config.int_type = BMI160_ACC_GYRO_FIFO_WATERMARK_INT;// Choosing FIFO watermark interrupt
+    int_config.fifo_wtm_int_en = BMI160_ENABLE;
+#else
     /* Select the Interrupt type */
     int_config.int_type = BMI160_ACC_GYRO_DATA_RDY_INT;// Choosing data ready interrupt
+#endif
     
     /* Select the interrupt channel/pin settings */
     int_config.int_pin_settg.output_en = BMI160_ENABLE;// Enabling interrupt pins to act as output pin
@@ -198,7 +538,7 @@ int bmi160_sensor_set_config(struct sensor_device_t *sensor) {
     int_config.int_pin_settg.input_en = BMI160_DISABLE;// Disabling interrupt pin to act as input
     int_config.int_pin_settg.latch_dur = BMI160_LATCH_DUR_NONE;// non-latched output
             
-    /* Set the data ready interrupt */
+    /* Set the data ready / FIFO watermark interrupt */
     if ((sensor->status = bmi160_set_int_config(&int_config, &sensor->device)) != BMI160_OK)
         return sensor->status;
     
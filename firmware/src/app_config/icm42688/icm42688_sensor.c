@@ -65,6 +65,35 @@
 #define _SNSRGYRORANGEEXPR(x) __SNSRGYRORANGEMACRO(x)
 #define _GET_IMU_GYRO_RANGE_MACRO() _SNSRGYRORANGEEXPR(SNSR_GYRO_RANGE)
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: FIFO configuration
+// *****************************************************************************
+// *****************************************************************************
+#if SNSR_USE_FIFO
+/* Leave at least half of the 2kB FIFO (16 byte packets) as headroom for read latency */
+#if (SNSR_FIFO_WATERMARK < 1) || (SNSR_FIFO_WATERMARK > 64)
+#error "SNSR_FIFO_WATERMARK must be between 1 and 64 for ICM42688"
+#endif
+
+/* Sensors that must be flagged valid in a FIFO packet for it to be kept */
+#define SNSR_FIFO_SENSOR_MASK ((SNSR_USE_ACCEL << INV_ICM426XX_SENSOR_ACCEL) \
+                            | (SNSR_USE_GYRO << INV_ICM426XX_SENSOR_GYRO))
+#endif
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Register burst read configuration
+// *****************************************************************************
+// *****************************************************************************
+/* A single burst covers MPUREG_ACCEL_DATA_X0_UI (0x1F) through MPUREG_INT_STATUS
+ * (0x2D); reading INT_STATUS last acknowledges the data ready interrupt in the
+ * same transaction */
+#define SNSR_BURST_START_REG    MPUREG_ACCEL_DATA_X0_UI
+#define SNSR_BURST_LEN          (MPUREG_INT_STATUS - SNSR_BURST_START_REG + 1)
+#define SNSR_BURST_ACCEL_OFFSET (MPUREG_ACCEL_DATA_X0_UI - SNSR_BURST_START_REG)
+#define SNSR_BURST_GYRO_OFFSET  (MPUREG_GYRO_DATA_X0_UI - SNSR_BURST_START_REG)
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Serial comms implementation
@@ -77,11 +106,15 @@ static int icm42688_spi_read (struct inv_icm426xx_serif * serif, uint8_t reg, ui
     
     MIKRO_CS_Clear();
     
-    if(!SERCOM0_SPI_Write(&reg, 1)) {
+    /* Let the DMA controller move the bytes and wait for it to finish */
+    SERCOM0_SPI_DMA_CallbackRegister(NULL, (uintptr_t) NULL);
+    if(!SERCOM0_SPI_DMA_WriteThenRead(&reg, 1, rbuffer, rlen)) {
         rval = -1;
     }
-    else if(!SERCOM0_SPI_Read(rbuffer, rlen)) {
-        rval = -1;
+    else {
+        while (SERCOM0_SPI_DMA_IsBusy()) { };
+        if (SERCOM0_SPI_DMA_ErrorGet())
+            rval = -1;
     }
     
     MIKRO_CS_Set();
@@ -118,6 +151,29 @@ static int icm42688_spi_write (struct inv_icm426xx_serif * serif, uint8_t reg, c
 // *****************************************************************************
 static snsr_data_t * l_snsr_buffer = NULL;
 
+/* State of the sample read in flight on the SPI DMA */
+static uint8_t l_snsr_burst_reg = 0x80 | SNSR_BURST_START_REG;
+static uint8_t l_snsr_burst[SNSR_BURST_LEN];
+static struct sensor_device_t * l_snsr_async_sensor = NULL;
+static snsr_data_t * l_snsr_async_buffer = NULL;
+static sensor_read_cb_t l_snsr_async_cb = NULL;
+#if SNSR_USE_FIFO
+static snsr_ringbuffer_t * l_snsr_ringbuffer = NULL;
+static ringbuffer_size_t l_snsr_dropped = 0;
+
+/* Buffer space reserved for a FIFO drain, filled in order and committed at the end */
+static snsr_ringbuffer_write_spans_t l_snsr_spans;
+static ringbuffer_size_t l_snsr_reserved = 0;
+static ringbuffer_size_t l_snsr_filled = 0;
+
+/* FIFO packet timestamps are 16 bit counts of l_tmst_res_q24 microseconds;
+ * they are accumulated in Q24 microseconds to extend them past a wrap */
+static uint32_t l_tmst_res_q24 = 0;
+static uint16_t l_tmst_last = 0;
+static uint64_t l_tmst_q24 = 0;
+static bool l_tmst_valid = false;
+#endif
+
 uint64_t inv_icm426xx_get_time_us(void) {
     return snsr_read_timer_us();
 }
@@ -126,8 +182,40 @@ void inv_icm426xx_sleep_us(uint32_t us) {
     snsr_sleep_us(us);
 }
 
-// Handle callback from inv_icm426xx_get_data_from_registers
+// Handle callback from inv_icm426xx_get_data_from_fifo
 void icm42688_sensor_event_cb(inv_icm426xx_sensor_event_t * event) {
+#if SNSR_USE_FIFO
+    if (l_snsr_ringbuffer == NULL) {
+        return;
+    }
+
+    /* Skip packets the driver has not flagged as valid (e.g. during sensor start-up) */
+    if ((event->sensor_mask & SNSR_FIFO_SENSOR_MASK) != SNSR_FIFO_SENSOR_MASK) {
+        return;
+    }
+
+    /* Track the sensor clock even for packets that get dropped */
+    if (!l_tmst_valid) {
+        /* Start from the MCU clock after a flush since the 16 bit count may have wrapped */
+        l_tmst_q24 = (uint64_t) snsr_read_timer_us() << 24;
+        l_tmst_valid = true;
+    }
+    else {
+        l_tmst_q24 += (uint64_t) (uint16_t) (event->timestamp_fsync - l_tmst_last) * l_tmst_res_q24;
+    }
+    l_tmst_last = event->timestamp_fsync;
+
+    if (l_snsr_filled == l_snsr_reserved) {
+        l_snsr_dropped++;
+        return;
+    }
+    if (l_snsr_filled < l_snsr_spans.itemcount[0])
+        l_snsr_buffer = l_snsr_spans.data[0][l_snsr_filled];
+    else
+        l_snsr_buffer = l_snsr_spans.data[1][l_snsr_filled - l_snsr_spans.itemcount[0]];
+    l_snsr_filled++;
+    snsr_set_timestamp(l_snsr_buffer, (uint32_t) (l_tmst_q24 >> 24));
+#endif
     if (l_snsr_buffer == NULL) {
         return;
     }
@@ -151,15 +239,24 @@ int icm42688_sensor_init(struct sensor_device_t *sensor) {
     sensor->serif.context   = 0;        /* no need */
     sensor->serif.read_reg  = icm42688_spi_read;
     sensor->serif.write_reg = icm42688_spi_write;
+#if SNSR_USE_FIFO
+    /* SPI reads go straight to the caller's buffer so allow a full FIFO burst */
+    sensor->serif.max_read  = ICM426XX_FIFO_MIRRORING_SIZE;
+#else
     sensor->serif.max_read  = SNSR_COM_BUF_SIZE-1;
+#endif
     sensor->serif.max_write = SNSR_COM_BUF_SIZE-1;
     sensor->serif.serif_type = ICM426XX_UI_SPI4;
     
     sensor->status = SNSR_STATUS_OK;
 
-    // Init and disable FIFO
+    // Init and configure FIFO
     sensor->status = inv_icm426xx_init(&sensor->device, &sensor->serif, icm42688_sensor_event_cb);
+#if SNSR_USE_FIFO
+    sensor->status |= inv_icm426xx_configure_fifo(&sensor->device, INV_ICM426XX_FIFO_ENABLED);
+#else
     sensor->status |= inv_icm426xx_configure_fifo(&sensor->device, INV_ICM426XX_FIFO_DISABLED);
+#endif
 
     uint8_t who_am_i;
     sensor->status |= inv_icm426xx_get_who_am_i(&sensor->device, &who_am_i);
@@ -171,8 +268,16 @@ int icm42688_sensor_init(struct sensor_device_t *sensor) {
 
 int icm42688_sensor_set_config(struct sensor_device_t *sensor) {
     /* Configure ICM */
+#if SNSR_USE_CLKIN
+    // Run from the MCU supplied CLKIN; the reference must be running before RTC mode is enabled
+    CLKIN_OutputEnable();
+    sensor->status |= inv_icm426xx_enable_clkin_rtc(&sensor->device, true);
+    if (inv_icm426xx_get_clkin_rtc_status(&sensor->device) != 1)
+        sensor->status |= INV_ERROR;
+#else
     // No sync clock - disable CLKIN
     sensor->status |= inv_icm426xx_enable_clkin_rtc(&sensor->device, false);
+#endif
 
     // Set sampling parameters
 #if SNSR_SAMPLE_RATE >= 1000
@@ -196,15 +301,127 @@ int icm42688_sensor_set_config(struct sensor_device_t *sensor) {
     sensor->status |= inv_icm426xx_enable_accel_low_noise_mode(&sensor->device);
     sensor->status |= inv_icm426xx_enable_gyro_low_noise_mode(&sensor->device);
     
+#if SNSR_USE_FIFO
+    // FIFO counts in packets (record mode) so the watermark is in samples
+    sensor->status |= inv_icm426xx_configure_fifo_wm(&sensor->device, SNSR_FIFO_WATERMARK);
+    sensor->status |= inv_icm426xx_reset_fifo(&sensor->device);
+    l_tmst_valid = false;
+
+    // Scale for the timestamp carried in each FIFO packet
+    l_tmst_res_q24 = inv_icm426xx_get_fifo_timestamp_resolution_us_q24(&sensor->device);
+    if (l_tmst_res_q24 == 0 || l_tmst_res_q24 == (uint32_t) INV_ERROR)
+        sensor->status |= INV_ERROR;
+#if SNSR_USE_CLKIN
+    // The driver assumes a 32.768kHz RTC tick; use the actual CLKIN period instead
+    l_tmst_res_q24 = (uint32_t) (((1000000ULL << 24) * CLKIN_DIVIDER) / CLKIN_SOURCE_HZ);
+#endif
+#else
     // Note DRDY interrupt is set up by default in inv_init function
+#endif
 
     return sensor->status;
 }
 
-int icm42688_sensor_read(struct sensor_device_t *sensor, snsr_data_t *ptr) {
-    l_snsr_buffer = ptr; // Set module scoped buffer pointer
-    sensor->status = inv_icm426xx_get_data_from_registers(&sensor->device);
-    l_snsr_buffer = NULL;
+static inline snsr_data_t icm42688_decode_sample(uint8_t endian, const uint8_t *in) {
+    if (endian == ICM426XX_INTF_CONFIG0_DATA_BIG_ENDIAN)
+        return (snsr_data_t) (int16_t) ((in[0] << 8) | in[1]);
+    else
+        return (snsr_data_t) (int16_t) ((in[1] << 8) | in[0]);
+}
+
+static void icm42688_decode_burst(uint8_t endian, const uint8_t *burst, snsr_data_t *ptr) {
+    /* Convert sensor data to buffer type and write to buffer */
+#if SNSR_USE_ACCEL
+    *ptr++ = icm42688_decode_sample(endian, &burst[SNSR_BURST_ACCEL_OFFSET + 0]);
+    *ptr++ = icm42688_decode_sample(endian, &burst[SNSR_BURST_ACCEL_OFFSET + 2]);
+    *ptr++ = icm42688_decode_sample(endian, &burst[SNSR_BURST_ACCEL_OFFSET + 4]);
+#endif
+#if SNSR_USE_GYRO
+    *ptr++ = icm42688_decode_sample(endian, &burst[SNSR_BURST_GYRO_OFFSET + 0]);
+    *ptr++ = icm42688_decode_sample(endian, &burst[SNSR_BURST_GYRO_OFFSET + 2]);
+    *ptr++ = icm42688_decode_sample(endian, &burst[SNSR_BURST_GYRO_OFFSET + 4]);
+#endif
+}
+
+// Handle completion of the SPI DMA transfer started by icm42688_sensor_read_async
+static void icm42688_sensor_read_complete(uintptr_t context) {
+    struct sensor_device_t *sensor = l_snsr_async_sensor;
+    
+    MIKRO_CS_Set();
+    
+    if (SERCOM0_SPI_DMA_ErrorGet()) {
+        sensor->status = INV_ERROR_TRANSPORT;
+    }
+    else {
+        icm42688_decode_burst(sensor->device.endianess_data, l_snsr_burst, l_snsr_async_buffer);
+        sensor->status = SNSR_STATUS_OK;
+    }
+    
+    l_snsr_async_cb(sensor);
+}
+
+int icm42688_sensor_read_async(struct sensor_device_t *sensor, snsr_data_t *ptr, sensor_read_cb_t callback) {
+    l_snsr_async_sensor = sensor;
+    l_snsr_async_buffer = ptr;
+    l_snsr_async_cb = callback;
+    
+    /* Set status before starting as the completion may preempt us */
+    sensor->status = SNSR_STATUS_OK;
+    
+    MIKRO_CS_Clear();
+    
+    /* Fetch accel, gyro and interrupt status with one SPI transaction rather
+     * than the four issued by inv_icm426xx_get_data_from_registers */
+    SERCOM0_SPI_DMA_CallbackRegister(icm42688_sensor_read_complete, (uintptr_t) NULL);
+    if (!SERCOM0_SPI_DMA_WriteThenRead(&l_snsr_burst_reg, 1, l_snsr_burst, SNSR_BURST_LEN)) {
+        MIKRO_CS_Set();
+        sensor->status = INV_ERROR_TRANSPORT;
+    }
+    
+    return sensor->status;
+}
+
+#if SNSR_USE_FIFO
+int icm42688_sensor_read_fifo(struct sensor_device_t *sensor, snsr_ringbuffer_t *ringbuffer, ringbuffer_size_t *dropped) {
+    int rval;
+
+    l_snsr_ringbuffer = ringbuffer; // Set module scoped ring buffer
+    l_snsr_dropped = 0;
     
+    /* Packets are decoded in place into all the free space, which is published once drained */
+    l_snsr_reserved = snsr_ringbuffer_reserve_write(ringbuffer, SNSR_BUF_LEN, &l_snsr_spans);
+    l_snsr_filled = 0;
+    rval = inv_icm426xx_get_data_from_fifo(&sensor->device);
+    snsr_ringbuffer_commit_write(ringbuffer, l_snsr_filled);
+    l_snsr_ringbuffer = NULL;
+    l_snsr_buffer = NULL;
+
+    *dropped = l_snsr_dropped;
+
+    /* On success inv_icm426xx_get_data_from_fifo returns the packet count */
+    sensor->status = (rval < 0) ? rval : SNSR_STATUS_OK;
+
+    return sensor->status;
+}
+
+int icm42688_sensor_flush_fifo(struct sensor_device_t *sensor) {
+    sensor->status = inv_icm426xx_reset_fifo(&sensor->device);
+    l_tmst_valid = false;
+
     return sensor->status;
-}
\ No newline at end of file
+}
+#endif
+
+/* TEMP_DATA1/0: 25degC at zero, 132.48 LSB per K */
+int icm42688_sensor_read_temperature(struct sensor_device_t *sensor, int16_t *centidegrees) {
+    uint8_t data[2];
+    int rval;
+    
+    rval = icm42688_spi_read(&sensor->serif, MPUREG_TEMP_DATA0_UI, data, sizeof(data));
+    if (rval < 0)
+        return rval;
+    
+    *centidegrees = (int16_t) (2500 + ((int32_t) icm42688_decode_sample(sensor->device.endianess_data, data) * 10000) / 13248);
+    
+    return SNSR_STATUS_OK;
+}
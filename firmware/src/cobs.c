@@ -0,0 +1,73 @@
+/*******************************************************************************
+  COBS Framing Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    cobs.c
+
+  Summary:
+    This file contains the COBS encoder used to frame binary packets
+ *******************************************************************************/
+/*******************************************************************************
+* Copyright (C) 2020 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *******************************************************************************/
+#include <stdint.h>
+#include "cobs.h"
+
+/* Largest number of bytes a block may span, its code byte included */
+#define COBS_BLOCK_MAX  0xFFU
+
+void cobs_encode_begin(cobs_encoder_t *encoder, uint8_t *dst) {
+    encoder->start = dst;
+    encoder->code = dst;
+    encoder->ptr = dst + 1;
+}
+
+void cobs_encode_put(cobs_encoder_t *encoder, const void *src, size_t len) {
+    const uint8_t *data = src;
+    uint8_t *code = encoder->code;
+    uint8_t *ptr = encoder->ptr;
+    
+    while (len--) {
+        uint8_t byte = *data++;
+        
+        if (byte != COBS_DELIMITER) {
+            *ptr++ = byte;
+            if (ptr - code < COBS_BLOCK_MAX)
+                continue;
+        }
+        /* The code byte holds the distance to the next zero (or block end) */
+        *code = (uint8_t) (ptr - code);
+        code = ptr++;
+    }
+    encoder->code = code;
+    encoder->ptr = ptr;
+}
+
+size_t cobs_encode_end(cobs_encoder_t *encoder) {
+    *encoder->code = (uint8_t) (encoder->ptr - encoder->code);
+    *encoder->ptr++ = COBS_DELIMITER;
+    
+    return encoder->ptr - encoder->start;
+}
@@ -0,0 +1,76 @@
+/*******************************************************************************
+  COBS Framing Interface Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    cobs.h
+
+  Summary:
+    This file contains the Consistent Overhead Byte Stuffing (COBS) encoder
+    used to frame binary packets
+
+  Notes:
+    - COBS rewrites a packet so it contains no zero bytes, at a cost of one
+      byte per 254; a zero then marks the end of every frame. A receiver that
+      loses or corrupts a byte resynchronizes at the next zero, so a line
+      error costs at most the frame it hit.
+    - The encoder is incremental: a frame may be built from several spans.
+ *******************************************************************************/
+/*******************************************************************************
+* Copyright (C) 2020 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *******************************************************************************/
+#ifndef COBS_H
+#define	COBS_H
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#define COBS_DELIMITER  0x00U
+
+/* Longest frame, delimiter included, that a packet of len bytes encodes to */
+#define COBS_ENCODED_MAXLEN(len)    ((len) + (len) / 254 + 2)
+
+typedef struct cobs_encoder {
+    uint8_t *start;     // first byte of the frame
+    uint8_t *code;      // code byte of the block being filled
+    uint8_t *ptr;       // next byte to write
+} cobs_encoder_t;
+
+/* Start a frame at dst, which must hold COBS_ENCODED_MAXLEN of the packet */
+void cobs_encode_begin(cobs_encoder_t *encoder, uint8_t *dst);
+
+/* Append len bytes of the packet to the frame */
+void cobs_encode_put(cobs_encoder_t *encoder, const void *src, size_t len);
+
+/* Close the frame with the delimiter; returns its length */
+size_t cobs_encode_end(cobs_encoder_t *encoder);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* COBS_H */
@@ -161,6 +161,8 @@ void SYS_Initialize ( void* data )
     SERCOM1_I2C_Initialize();
 
     EVSYS_Initialize();
+
+    DMAC_Initialize();
 
 	SYSTICK_TimerInitialize();
     SERCOM5_USART_Initialize();
@@ -60,6 +60,7 @@ void Reset_Handler (void);
 void NonMaskableInt_Handler (void);
 void HardFault_Handler (void);
 void EIC_InterruptHandler (void);
+void DMAC_InterruptHandler (void);
 void SERCOM1_I2C_InterruptHandler (void);
 void SERCOM5_Handler (void);
 void TC3_TimerInterruptHandler (void);
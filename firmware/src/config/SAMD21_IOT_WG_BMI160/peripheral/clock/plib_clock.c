@@ -126,7 +126,7 @@ void CLOCK_Initialize (void)
     PM_REGS->PM_APBAMASK = 0x5f;
 
     /* Configure the APBC Bridge Clocks */
-    PM_REGS->PM_APBCMASK = 0x10888;
+    PM_REGS->PM_APBCMASK = 0x1088a;
 
 
     /*Disable RC oscillator*/
@@ -0,0 +1,243 @@
+/*******************************************************************************
+  Direct Memory Access Controller (DMAC) PLIB
+
+  Company
+    Microchip Technology Inc.
+
+  File Name
+    plib_dmac.c
+
+  Summary
+    DMAC PLIB Implementation File.
+
+  Description
+    This file defines the interface to the DMAC peripheral library. This
+    library provides access to and control of the associated peripheral
+    instance.
+
+  Remarks:
+    None.
+
+*******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2018 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+/* This section lists the other files that are included in this file.
+*/
+
+#include <string.h>
+#include "plib_dmac.h"
+#include "interrupts.h"
+#include "peripheral/nvic/plib_nvic.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Global Data
+// *****************************************************************************
+// *****************************************************************************
+
+static volatile DMAC_CHANNEL_OBJECT dmacChannelObj[DMAC_CHANNELS_NUMBER];
+
+/* Initial descriptor and write-back memory sections must be 128-bit aligned */
+static dmac_descriptor_registers_t descriptor_section[DMAC_CHANNELS_NUMBER] __ALIGNED(16);
+static dmac_descriptor_registers_t write_back_section[DMAC_CHANNELS_NUMBER] __ALIGNED(16);
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: DMAC Implementation
+// *****************************************************************************
+// *****************************************************************************
+
+// *****************************************************************************
+/* Initialize the DMAC module and the configured channels */
+void DMAC_Initialize( void )
+{
+    uint8_t channel;
+
+    /* Disable and reset the DMAC module */
+    DMAC_REGS->DMAC_CTRL &= (uint16_t)(~DMAC_CTRL_DMAENABLE_Msk);
+
+    while((DMAC_REGS->DMAC_CTRL & DMAC_CTRL_DMAENABLE_Msk) != 0U)
+    {
+        /* Wait for the module to be disabled */
+    }
+
+    DMAC_REGS->DMAC_CTRL = DMAC_CTRL_SWRST_Msk;
+
+    while((DMAC_REGS->DMAC_CTRL & DMAC_CTRL_SWRST_Msk) != 0U)
+    {
+        /* Wait for the reset to complete */
+    }
+
+    /* Initialize the channel objects */
+    for(channel = 0U; channel < DMAC_CHANNELS_NUMBER; channel++)
+    {
+        dmacChannelObj[channel].callback = NULL;
+        dmacChannelObj[channel].context = 0U;
+        dmacChannelObj[channel].busyStatus = false;
+    }
+
+    /* Update the Base address and Write Back address register */
+    DMAC_REGS->DMAC_BASEADDR = (uint32_t) descriptor_section;
+    DMAC_REGS->DMAC_WRBADDR  = (uint32_t) write_back_section;
+
+    /* Update the Priority Control register */
+    DMAC_REGS->DMAC_PRICTRL0 = 0U;
+
+    /***************** Configure DMA channel 0 ********************/
+
+    DMAC_REGS->DMAC_CHID = 0U;
+
+    /* SERCOM5 TX trigger, one beat per trigger, highest priority level */
+    DMAC_REGS->DMAC_CHCTRLB = DMAC_CHCTRLB_TRIGACT(DMAC_CHCTRLB_TRIGACT_BEAT_Val) | DMAC_CHCTRLB_TRIGSRC(SERCOM5_DMAC_ID_TX) | DMAC_CHCTRLB_LVL(0U);
+
+    DMAC_REGS->DMAC_CHINTENSET = (uint8_t)(DMAC_CHINTENSET_TERR_Msk | DMAC_CHINTENSET_TCMPL_Msk);
+
+    /* Enable the DMAC module and priority level 0 */
+    DMAC_REGS->DMAC_CTRL = (uint16_t)(DMAC_CTRL_DMAENABLE_Msk | DMAC_CTRL_LVLEN0_Msk);
+}
+
+/* Register callback for a DMAC channel */
+void DMAC_ChannelCallbackRegister( DMAC_CHANNEL channel, const DMAC_CHANNEL_CALLBACK callback, const uintptr_t context )
+{
+    dmacChannelObj[channel].callback = callback;
+    dmacChannelObj[channel].context = context;
+}
+
+/* Start a transfer described by a (possibly linked) list of descriptors.
+   The first descriptor is copied to the channel's descriptor section, any
+   descriptors it links to must stay valid until the transfer completes. */
+bool DMAC_ChannelLinkedListTransfer( DMAC_CHANNEL channel, const dmac_descriptor_registers_t *channelDesc )
+{
+    bool returnStatus = false;
+    bool interruptState;
+    uint8_t channelId;
+
+    /* The interrupt handler also selects channels and starts transfers, keep
+       the busy check, descriptor update and enable atomic. Callers may already
+       hold interrupts off so restore rather than unconditionally enable. */
+    interruptState = NVIC_INT_Disable();
+
+    if(dmacChannelObj[channel].busyStatus == false)
+    {
+        dmacChannelObj[channel].busyStatus = true;
+
+        (void) memcpy(&descriptor_section[channel], channelDesc, sizeof(dmac_descriptor_registers_t));
+
+        channelId = DMAC_REGS->DMAC_CHID;
+        DMAC_REGS->DMAC_CHID = (uint8_t)channel;
+        DMAC_REGS->DMAC_CHCTRLA |= DMAC_CHCTRLA_ENABLE_Msk;
+        DMAC_REGS->DMAC_CHID = channelId;
+
+        returnStatus = true;
+    }
+
+    NVIC_INT_Restore(interruptState);
+
+    return returnStatus;
+}
+
+/* Abort any transfer in progress on a DMAC channel */
+void DMAC_ChannelDisable( DMAC_CHANNEL channel )
+{
+    bool interruptState;
+    uint8_t channelId;
+
+    interruptState = NVIC_INT_Disable();
+    channelId = DMAC_REGS->DMAC_CHID;
+    DMAC_REGS->DMAC_CHID = (uint8_t)channel;
+    DMAC_REGS->DMAC_CHCTRLA &= (uint8_t)(~DMAC_CHCTRLA_ENABLE_Msk);
+
+    while((DMAC_REGS->DMAC_CHCTRLA & DMAC_CHCTRLA_ENABLE_Msk) != 0U)
+    {
+        /* Wait till the channel is disabled */
+    }
+
+    DMAC_REGS->DMAC_CHINTFLAG = (uint8_t)DMAC_CHINTFLAG_Msk;
+    DMAC_REGS->DMAC_CHID = channelId;
+
+    dmacChannelObj[channel].busyStatus = false;
+
+    NVIC_INT_Restore(interruptState);
+}
+
+/* Check whether a transfer is in progress on a DMAC channel */
+bool DMAC_ChannelIsBusy( DMAC_CHANNEL channel )
+{
+    return dmacChannelObj[channel].busyStatus;
+}
+
+void DMAC_InterruptHandler( void )
+{
+    volatile DMAC_CHANNEL_OBJECT *dmacChObj;
+    DMAC_TRANSFER_EVENT event = DMAC_TRANSFER_EVENT_NONE;
+    uint8_t channel;
+    uint8_t channelId;
+    uint8_t chanIntFlagStatus;
+
+    /* Save the channel ID in case a channel access was preempted */
+    channelId = DMAC_REGS->DMAC_CHID;
+
+    /* Get the lowest numbered channel with a pending interrupt */
+    channel = (uint8_t)(DMAC_REGS->DMAC_INTPEND & DMAC_INTPEND_ID_Msk);
+    dmacChObj = &dmacChannelObj[channel];
+
+    DMAC_REGS->DMAC_CHID = channel;
+    chanIntFlagStatus = DMAC_REGS->DMAC_CHINTFLAG;
+
+    if((chanIntFlagStatus & DMAC_CHINTFLAG_TERR_Msk) != 0U)
+    {
+        /* Transfer error, the channel is disabled by hardware */
+        DMAC_REGS->DMAC_CHINTFLAG = (uint8_t)DMAC_CHINTFLAG_TERR_Msk;
+        event = DMAC_TRANSFER_EVENT_ERROR;
+    }
+    else if((chanIntFlagStatus & DMAC_CHINTFLAG_TCMPL_Msk) != 0U)
+    {
+        DMAC_REGS->DMAC_CHINTFLAG = (uint8_t)DMAC_CHINTFLAG_TCMPL_Msk;
+        event = DMAC_TRANSFER_EVENT_COMPLETE;
+    }
+    else
+    {
+        /* Do nothing */
+    }
+
+    DMAC_REGS->DMAC_CHID = channelId;
+
+    if(event != DMAC_TRANSFER_EVENT_NONE)
+    {
+        dmacChObj->busyStatus = false;
+
+        if(dmacChObj->callback != NULL)
+        {
+            dmacChObj->callback(event, dmacChObj->context);
+        }
+    }
+}
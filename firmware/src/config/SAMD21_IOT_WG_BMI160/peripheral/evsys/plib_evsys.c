@@ -45,7 +45,10 @@
 void EVSYS_Initialize( void )
 {
     /*Event Channel User Configuration*/
+    EVSYS_REGS->EVSYS_USER = EVSYS_USER_CHANNEL(0x1) | EVSYS_USER_USER(EVENT_ID_USER_TC3_EVU);
 
+    /* Event Channel 0 Configuration: EXTINT12 (MIKRO_INT) edges to the TC3 capture input */
+    EVSYS_REGS->EVSYS_CHANNEL = EVSYS_CHANNEL_EVGEN(EVENT_ID_GEN_EIC_EXTINT_12) | EVSYS_CHANNEL_PATH_ASYNCHRONOUS | EVSYS_CHANNEL_EDGSEL_NO_EVT_OUTPUT | EVSYS_CHANNEL_CHANNEL(0);
 
 }
 
@@ -83,11 +83,12 @@ void TC3_TimerInitialize( void )
         /* Wait for Write Synchronization */
     }
 
-    /* Configure counter mode & prescaler */
-    TC3_REGS->COUNT16.TC_CTRLA = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER_DIV16 | TC_CTRLA_WAVEGEN_MPWM ;
+    /* Configure counter mode & prescaler; free running over the full 16 bit range */
+    TC3_REGS->COUNT16.TC_CTRLA = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER_DIV16 | TC_CTRLA_WAVEGEN_NFRQ ;
 
-    /* Configure timer period */
-    TC3_REGS->COUNT16.TC_CC[0U] = 1000U;
+    /* Capture the count into CC0 on each event from EVSYS */
+    TC3_REGS->COUNT16.TC_CTRLC = TC_CTRLC_CPTEN0_Msk;
+    TC3_REGS->COUNT16.TC_EVCTRL = TC_EVCTRL_TCEI_Msk | TC_EVCTRL_EVACT_OFF;
 
     /* Clear all interrupt flags */
     TC3_REGS->COUNT16.TC_INTFLAG = TC_INTFLAG_Msk;
@@ -101,6 +102,9 @@ void TC3_TimerInitialize( void )
     {
         /* Wait for Write Synchronization */
     }
+
+    /* Keep COUNT synchronized so it can be read without waiting */
+    TC3_REGS->COUNT16.TC_READREQ = TC_READREQ_RCONT_Msk | TC_COUNT16_COUNT_REG_OFST;
 }
 
 /* Enable the TC counter */
@@ -140,16 +144,38 @@ void TC3_TimerCommandSet(TC_COMMAND command)
 /* Get the current timer counter value */
 uint16_t TC3_Timer16bitCounterGet( void )
 {
-    /* Write command to force COUNT register read synchronization */
-    TC3_REGS->COUNT16.TC_READREQ = TC_READREQ_RREQ_Msk | TC_COUNT16_COUNT_REG_OFST;
+    /* COUNT is continuously synchronized (see TC3_TimerInitialize) */
+    return (uint16_t)TC3_REGS->COUNT16.TC_COUNT;
+}
+
+/* Get the count latched by the last capture event */
+uint16_t TC3_Timer16bitCaptureGet( void )
+{
+    /* Write command to force CC register read synchronization */
+    TC3_REGS->COUNT16.TC_READREQ = TC_READREQ_RREQ_Msk | TC_COUNT16_CC_REG_OFST;
 
     while((TC3_REGS->COUNT16.TC_STATUS & TC_STATUS_SYNCBUSY_Msk))
     {
-        /* Wait for Write Synchronization */
+        /* Wait for Read Synchronization */
     }
+    uint16_t capture = (uint16_t)TC3_REGS->COUNT16.TC_CC[0];
 
-    /* Read current count value */
-    return (uint16_t)TC3_REGS->COUNT16.TC_COUNT;
+    /* Restore continuous synchronization of COUNT, waiting for the first so
+       TC3_Timer16bitCounterGet never sees a stale count */
+    TC3_REGS->COUNT16.TC_READREQ = TC_READREQ_RREQ_Msk | TC_READREQ_RCONT_Msk | TC_COUNT16_COUNT_REG_OFST;
+
+    while((TC3_REGS->COUNT16.TC_STATUS & TC_STATUS_SYNCBUSY_Msk))
+    {
+        /* Wait for Read Synchronization */
+    }
+
+    return capture;
+}
+
+/* Check for a counter overflow that has not been serviced by the interrupt handler yet */
+bool TC3_TimerOverflowPending( void )
+{
+    return ((TC3_REGS->COUNT16.TC_INTFLAG & TC_INTFLAG_OVF_Msk) != 0U);
 }
 
 /* Configure timer counter value */
@@ -183,7 +209,18 @@ uint16_t TC3_Timer16bitPeriodGet( void )
     {
         /* Wait for Write Synchronization */
     }
-    return (uint16_t)TC3_REGS->COUNT16.TC_CC[0];
+    uint16_t period = (uint16_t)TC3_REGS->COUNT16.TC_CC[0];
+
+    /* Restore continuous synchronization of COUNT, waiting for the first so
+       TC3_Timer16bitCounterGet never sees a stale count */
+    TC3_REGS->COUNT16.TC_READREQ = TC_READREQ_RREQ_Msk | TC_READREQ_RCONT_Msk | TC_COUNT16_COUNT_REG_OFST;
+
+    while((TC3_REGS->COUNT16.TC_STATUS & TC_STATUS_SYNCBUSY_Msk))
+    {
+        /* Wait for Read Synchronization */
+    }
+
+    return period;
 }
 
 
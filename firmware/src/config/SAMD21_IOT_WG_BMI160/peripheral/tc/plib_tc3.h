@@ -104,6 +104,10 @@ uint16_t TC3_Timer16bitCounterGet( void );
 
 void TC3_Timer16bitCounterSet( uint16_t count );
 
+bool TC3_TimerOverflowPending( void );
+
+uint16_t TC3_Timer16bitCaptureGet( void );
+
 
 
 
@@ -63,7 +63,8 @@ void _mon_putc(char c)
    bool success = false;
    do
    {
-       success = SERCOM5_USART_Write(&c, 1);
+       /* Queue behind any DMA transmission so output is not interleaved */
+       success = SERCOM5_USART_DMA_Write(&c, 1);
    }while (!success);
 }
 
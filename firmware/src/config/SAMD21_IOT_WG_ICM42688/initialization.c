@@ -160,6 +160,8 @@ void SYS_Initialize ( void* data )
 
     EVSYS_Initialize();
 
+    DMAC_Initialize();
+
     SERCOM0_SPI_Initialize();
 
 	SYSTICK_TimerInitialize();
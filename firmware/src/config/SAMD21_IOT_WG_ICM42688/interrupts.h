@@ -61,6 +61,7 @@ void NonMaskableInt_Handler (void);
 void HardFault_Handler (void);
 void SysTick_Handler (void);
 void EIC_InterruptHandler (void);
+void DMAC_InterruptHandler (void);
 void SERCOM5_Handler (void);
 void TC3_TimerInterruptHandler (void);
 
@@ -92,17 +92,31 @@ static void GCLK0_Initialize(void)
 }
 
 
+/* Generator 1 provides the ~32.764kHz ICM42688 CLKIN reference (DFLL48M / 1465);
+   it is the only generator with a divider wide enough */
 static void GCLK1_Initialize(void)
 {
-    GCLK_REGS->GCLK_GENCTRL = GCLK_GENCTRL_SRC(7) | GCLK_GENCTRL_GENEN_Msk | GCLK_GENCTRL_ID(1);
+    GCLK_REGS->GCLK_GENCTRL = GCLK_GENCTRL_SRC(7) | GCLK_GENCTRL_GENEN_Msk | GCLK_GENCTRL_IDC_Msk | GCLK_GENCTRL_OE_Msk | GCLK_GENCTRL_ID(1);
 
-    GCLK_REGS->GCLK_GENDIV = GCLK_GENDIV_DIV(3) | GCLK_GENDIV_ID(1);
+    GCLK_REGS->GCLK_GENDIV = GCLK_GENDIV_DIV(1465) | GCLK_GENDIV_ID(1);
     while((GCLK_REGS->GCLK_STATUS & GCLK_STATUS_SYNCBUSY_Msk) == GCLK_STATUS_SYNCBUSY_Msk)
     {
         /* wait for the Generator 1 synchronization */
     }
 }
 
+
+static void GCLK3_Initialize(void)
+{
+    GCLK_REGS->GCLK_GENCTRL = GCLK_GENCTRL_SRC(7) | GCLK_GENCTRL_GENEN_Msk | GCLK_GENCTRL_ID(3);
+
+    GCLK_REGS->GCLK_GENDIV = GCLK_GENDIV_DIV(3) | GCLK_GENDIV_ID(3);
+    while((GCLK_REGS->GCLK_STATUS & GCLK_STATUS_SYNCBUSY_Msk) == GCLK_STATUS_SYNCBUSY_Msk)
+    {
+        /* wait for the Generator 3 synchronization */
+    }
+}
+
 void CLOCK_Initialize (void)
 {
     /* Function to Initialize the Oscillators */
@@ -111,6 +125,7 @@ void CLOCK_Initialize (void)
     DFLL_Initialize();
     GCLK0_Initialize();
     GCLK1_Initialize();
+    GCLK3_Initialize();
 
 
     /* Selection of the Generator and write Lock for EIC */
@@ -120,13 +135,13 @@ void CLOCK_Initialize (void)
     /* Selection of the Generator and write Lock for SERCOM5_CORE */
     GCLK_REGS->GCLK_CLKCTRL = GCLK_CLKCTRL_ID(25) | GCLK_CLKCTRL_GEN(0x0)  | GCLK_CLKCTRL_CLKEN_Msk;
     /* Selection of the Generator and write Lock for TC3 TCC2 */
-    GCLK_REGS->GCLK_CLKCTRL = GCLK_CLKCTRL_ID(27) | GCLK_CLKCTRL_GEN(0x1)  | GCLK_CLKCTRL_CLKEN_Msk;
+    GCLK_REGS->GCLK_CLKCTRL = GCLK_CLKCTRL_ID(27) | GCLK_CLKCTRL_GEN(0x3)  | GCLK_CLKCTRL_CLKEN_Msk;
 
     /* Configure the APBA Bridge Clocks */
     PM_REGS->PM_APBAMASK = 0x5f;
 
     /* Configure the APBC Bridge Clocks */
-    PM_REGS->PM_APBCMASK = 0x10884;
+    PM_REGS->PM_APBCMASK = 0x10886;
 
 
     /*Disable RC oscillator*/
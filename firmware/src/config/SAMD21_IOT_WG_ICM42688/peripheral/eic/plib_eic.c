@@ -101,6 +101,9 @@ void EIC_Initialize(void)
     /* External Interrupt enable*/
     EIC_REGS->EIC_INTENSET = 0x1000;
 
+    /* Event Control */
+    EIC_REGS->EIC_EVCTRL = 0x1000;
+
     /* Callbacks for enabled interrupts */
     eicCallbackObject[0].eicPinNo = EIC_PIN_MAX;
     eicCallbackObject[1].eicPinNo = EIC_PIN_MAX;
@@ -386,3 +386,162 @@ bool SERCOM0_SPI_Read(void* pReceiveData, size_t rxSize)
     return SERCOM0_SPI_WriteRead(NULL, 0U, pReceiveData, rxSize);
 }
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: SERCOM0_SPI DMA Implementation
+// *****************************************************************************
+// *****************************************************************************
+
+#define SERCOM0_SPI_DMA_RX_CHANNEL      DMAC_CHANNEL_0
+#define SERCOM0_SPI_DMA_TX_CHANNEL      DMAC_CHANNEL_1
+
+/* Maximum block transfer count of a DMA descriptor */
+#define SERCOM0_SPI_DMA_MAX_COUNT       (0xFFFFU)
+
+typedef struct
+{
+    bool                     transferIsBusy;
+
+    bool                     transferError;
+
+    SERCOM_SPI_CALLBACK      callback;
+
+    uintptr_t                context;
+
+} SERCOM_SPI_DMA_OBJECT;
+
+static volatile SERCOM_SPI_DMA_OBJECT sercom0SPIDMAObj;
+
+/* Descriptors linked from the channel descriptors for the data phase */
+static dmac_descriptor_registers_t sercom0SPIDMATxDummyDesc __ALIGNED(16);
+static dmac_descriptor_registers_t sercom0SPIDMARxDataDesc __ALIGNED(16);
+
+static uint8_t sercom0SPIDMATxDummy = 0xFFU;
+static uint8_t sercom0SPIDMARxDummy;
+
+static void SERCOM0_SPI_DMA_TransferHandler(DMAC_TRANSFER_EVENT event, uintptr_t context)
+{
+    DMAC_CHANNEL channel = (DMAC_CHANNEL)context;
+
+    /* The transfer is finished once the last byte is received; the TX channel
+       has always completed by then */
+    if((event == DMAC_TRANSFER_EVENT_ERROR) || (channel == SERCOM0_SPI_DMA_RX_CHANNEL))
+    {
+        if(sercom0SPIDMAObj.transferIsBusy == false)
+        {
+            return;
+        }
+
+        DMAC_ChannelDisable(SERCOM0_SPI_DMA_RX_CHANNEL);
+        DMAC_ChannelDisable(SERCOM0_SPI_DMA_TX_CHANNEL);
+
+        sercom0SPIDMAObj.transferError = (event == DMAC_TRANSFER_EVENT_ERROR);
+        sercom0SPIDMAObj.transferIsBusy = false;
+
+        if(sercom0SPIDMAObj.callback != NULL)
+        {
+            sercom0SPIDMAObj.callback(sercom0SPIDMAObj.context);
+        }
+    }
+}
+
+void SERCOM0_SPI_DMA_CallbackRegister(const SERCOM_SPI_CALLBACK callBack, uintptr_t context)
+{
+    sercom0SPIDMAObj.callback = callBack;
+    sercom0SPIDMAObj.context = context;
+}
+
+bool SERCOM0_SPI_DMA_WriteThenRead(void* pTransmitData, size_t txSize, void* pReceiveData, size_t rxSize)
+{
+    dmac_descriptor_registers_t rxDesc;
+    dmac_descriptor_registers_t txDesc;
+    size_t receivedData;
+
+    /* Verify the request */
+    if((pTransmitData == NULL) || (txSize == 0U) || (txSize > SERCOM0_SPI_DMA_MAX_COUNT)
+        || ((rxSize > 0U) && (pReceiveData == NULL)) || (rxSize > SERCOM0_SPI_DMA_MAX_COUNT))
+    {
+        return false;
+    }
+
+    if(sercom0SPIDMAObj.transferIsBusy == true)
+    {
+        return false;
+    }
+
+    sercom0SPIDMAObj.transferIsBusy = true;
+    sercom0SPIDMAObj.transferError = false;
+
+    DMAC_ChannelCallbackRegister(SERCOM0_SPI_DMA_RX_CHANNEL, SERCOM0_SPI_DMA_TransferHandler, (uintptr_t)SERCOM0_SPI_DMA_RX_CHANNEL);
+    DMAC_ChannelCallbackRegister(SERCOM0_SPI_DMA_TX_CHANNEL, SERCOM0_SPI_DMA_TransferHandler, (uintptr_t)SERCOM0_SPI_DMA_TX_CHANNEL);
+
+    /* Flush out any unread data in SPI DATA Register from the previous transfer */
+    while((SERCOM0_REGS->SPIM.SERCOM_INTFLAG & SERCOM_SPIM_INTFLAG_RXC_Msk) == SERCOM_SPIM_INTFLAG_RXC_Msk)
+    {
+        receivedData = SERCOM0_REGS->SPIM.SERCOM_DATA;
+    }
+    (void)receivedData;
+
+    SERCOM0_REGS->SPIM.SERCOM_STATUS |= (uint16_t)SERCOM_SPIM_STATUS_BUFOVF_Msk;
+
+    SERCOM0_REGS->SPIM.SERCOM_INTFLAG |= (uint8_t)SERCOM_SPIM_INTFLAG_ERROR_Msk;
+
+    /* RX: discard the bytes clocked in during the transmit phase ... */
+    rxDesc.DMAC_BTCTRL = (uint16_t)(DMAC_BTCTRL_VALID_Msk | DMAC_BTCTRL_BEATSIZE_BYTE
+                        | ((rxSize > 0U) ? DMAC_BTCTRL_BLOCKACT_NOACT : DMAC_BTCTRL_BLOCKACT_INT));
+    rxDesc.DMAC_BTCNT = (uint16_t)txSize;
+    rxDesc.DMAC_SRCADDR = (uint32_t)&SERCOM0_REGS->SPIM.SERCOM_DATA;
+    rxDesc.DMAC_DSTADDR = (uint32_t)&sercom0SPIDMARxDummy;
+    rxDesc.DMAC_DESCADDR = (rxSize > 0U) ? (uint32_t)&sercom0SPIDMARxDataDesc : 0U;
+
+    /* ... then store the data phase (incrementing addresses point at the end of the block) */
+    sercom0SPIDMARxDataDesc.DMAC_BTCTRL = (uint16_t)(DMAC_BTCTRL_VALID_Msk | DMAC_BTCTRL_BEATSIZE_BYTE
+                        | DMAC_BTCTRL_DSTINC_Msk | DMAC_BTCTRL_BLOCKACT_INT);
+    sercom0SPIDMARxDataDesc.DMAC_BTCNT = (uint16_t)rxSize;
+    sercom0SPIDMARxDataDesc.DMAC_SRCADDR = (uint32_t)&SERCOM0_REGS->SPIM.SERCOM_DATA;
+    sercom0SPIDMARxDataDesc.DMAC_DSTADDR = (uint32_t)pReceiveData + rxSize;
+    sercom0SPIDMARxDataDesc.DMAC_DESCADDR = 0U;
+
+    /* TX: send the transmit buffer ... */
+    txDesc.DMAC_BTCTRL = (uint16_t)(DMAC_BTCTRL_VALID_Msk | DMAC_BTCTRL_BEATSIZE_BYTE
+                        | DMAC_BTCTRL_SRCINC_Msk | DMAC_BTCTRL_BLOCKACT_NOACT);
+    txDesc.DMAC_BTCNT = (uint16_t)txSize;
+    txDesc.DMAC_SRCADDR = (uint32_t)pTransmitData + txSize;
+    txDesc.DMAC_DSTADDR = (uint32_t)&SERCOM0_REGS->SPIM.SERCOM_DATA;
+    txDesc.DMAC_DESCADDR = (rxSize > 0U) ? (uint32_t)&sercom0SPIDMATxDummyDesc : 0U;
+
+    /* ... then clock out dummy bytes for the data phase */
+    sercom0SPIDMATxDummyDesc.DMAC_BTCTRL = (uint16_t)(DMAC_BTCTRL_VALID_Msk | DMAC_BTCTRL_BEATSIZE_BYTE
+                        | DMAC_BTCTRL_BLOCKACT_NOACT);
+    sercom0SPIDMATxDummyDesc.DMAC_BTCNT = (uint16_t)rxSize;
+    sercom0SPIDMATxDummyDesc.DMAC_SRCADDR = (uint32_t)&sercom0SPIDMATxDummy;
+    sercom0SPIDMATxDummyDesc.DMAC_DSTADDR = (uint32_t)&SERCOM0_REGS->SPIM.SERCOM_DATA;
+    sercom0SPIDMATxDummyDesc.DMAC_DESCADDR = 0U;
+
+    /* Arm the receiver before the transmitter starts clocking */
+    if(!DMAC_ChannelLinkedListTransfer(SERCOM0_SPI_DMA_RX_CHANNEL, &rxDesc))
+    {
+        sercom0SPIDMAObj.transferIsBusy = false;
+        return false;
+    }
+
+    if(!DMAC_ChannelLinkedListTransfer(SERCOM0_SPI_DMA_TX_CHANNEL, &txDesc))
+    {
+        DMAC_ChannelDisable(SERCOM0_SPI_DMA_RX_CHANNEL);
+        sercom0SPIDMAObj.transferIsBusy = false;
+        return false;
+    }
+
+    return true;
+}
+
+bool SERCOM0_SPI_DMA_IsBusy(void)
+{
+    return sercom0SPIDMAObj.transferIsBusy;
+}
+
+bool SERCOM0_SPI_DMA_ErrorGet(void)
+{
+    return sercom0SPIDMAObj.transferError;
+}
+
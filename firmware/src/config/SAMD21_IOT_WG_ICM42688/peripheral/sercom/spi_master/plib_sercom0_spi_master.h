@@ -57,6 +57,7 @@
 */
 
 #include "plib_sercom_spi_master_common.h"
+#include "peripheral/dmac/plib_dmac.h"
 
 // DOM-IGNORE-BEGIN
 #ifdef __cplusplus // Provide C++ Compatibility
@@ -465,6 +466,142 @@ bool SERCOM0_SPI_Write(void* pTransmitData, size_t txSize);
 
 bool SERCOM0_SPI_Read(void* pReceiveData, size_t rxSize);
 
+// *****************************************************************************
+/* Function:
+    void SERCOM0_SPI_DMA_CallbackRegister(const SERCOM_SPI_CALLBACK callBack,
+                                                            uintptr_t context);
+
+  Summary:
+    Registers the function to be called when a DMA transfer has completed.
+
+  Description:
+    This function registers the callback function to be called by the DMAC
+    interrupt handler when a transfer started with
+    SERCOM0_SPI_DMA_WriteThenRead() has completed. Passing NULL removes the
+    callback.
+
+  Precondition:
+    DMAC_Initialize() must have been called to set up the SERCOM0 RX and TX
+    DMA channels.
+
+  Parameters:
+    callBack - Pointer to the callback function, called from interrupt context.
+
+    context - The value of parameter will be passed back to the application
+    unchanged, when the callback function is called.
+
+  Returns:
+    None.
+
+  Remarks:
+    The callback should be registered before the transfer is started.
+*/
+
+void SERCOM0_SPI_DMA_CallbackRegister(const SERCOM_SPI_CALLBACK callBack, uintptr_t context);
+
+// *****************************************************************************
+/* Function:
+    bool SERCOM0_SPI_DMA_WriteThenRead(void* pTransmitData, size_t txSize,
+                                        void* pReceiveData, size_t rxSize);
+
+  Summary:
+    Writes and then reads data on SERCOM0 SPI using the DMA controller.
+
+  Description:
+    This function transmits txSize bytes from pTransmitData, then clocks out
+    rxSize dummy bytes and stores the bytes received during that phase in
+    pReceiveData. Bytes received while transmitting are discarded. This matches
+    a register read transaction: address phase followed by data phase.
+
+    The function is non-blocking. The transfer is handled by two linked DMA
+    descriptor chains, one per direction, and no CPU involvement is required
+    until completion. Completion is signalled through the callback registered
+    with SERCOM0_SPI_DMA_CallbackRegister() or can be polled with
+    SERCOM0_SPI_DMA_IsBusy(). Both buffers are owned by the library until then.
+
+  Precondition:
+    SERCOM0_SPI_Initialize() and DMAC_Initialize() must have been called.
+    The blocking SERCOM0_SPI_WriteRead() must not be used while a DMA
+    transfer is in progress.
+
+  Parameters:
+    pTransmitData - Pointer to the bytes to be transmitted.
+
+    txSize - Number of bytes to be transmitted (1 to 65535).
+
+    pReceiveData - Pointer to the location where received bytes are stored.
+    May be NULL when rxSize is 0.
+
+    rxSize - Number of bytes to be received after transmission (0 to 65535).
+
+  Returns:
+    true - The transfer was started.
+
+    false - The arguments are invalid or a transfer is already in progress.
+
+  Remarks:
+    Chip select handling is left to the application.
+*/
+
+bool SERCOM0_SPI_DMA_WriteThenRead(void* pTransmitData, size_t txSize, void* pReceiveData, size_t rxSize);
+
+// *****************************************************************************
+/* Function:
+    bool SERCOM0_SPI_DMA_IsBusy(void);
+
+  Summary:
+    Returns the status of a SERCOM0 SPI DMA transfer.
+
+  Description:
+    This function returns true while a transfer started with
+    SERCOM0_SPI_DMA_WriteThenRead() is in progress.
+
+  Precondition:
+    None.
+
+  Parameters:
+    None.
+
+  Returns:
+    true - A DMA transfer is in progress.
+
+    false - No DMA transfer is in progress.
+
+  Remarks:
+    None.
+*/
+
+bool SERCOM0_SPI_DMA_IsBusy(void);
+
+// *****************************************************************************
+/* Function:
+    bool SERCOM0_SPI_DMA_ErrorGet(void);
+
+  Summary:
+    Returns whether the last SERCOM0 SPI DMA transfer failed.
+
+  Description:
+    This function returns true if the DMA controller reported a transfer
+    error for the last transfer started with SERCOM0_SPI_DMA_WriteThenRead().
+    The value is valid once SERCOM0_SPI_DMA_IsBusy() returns false.
+
+  Precondition:
+    None.
+
+  Parameters:
+    None.
+
+  Returns:
+    true - The last DMA transfer was aborted with an error.
+
+    false - The last DMA transfer completed successfully.
+
+  Remarks:
+    None.
+*/
+
+bool SERCOM0_SPI_DMA_ErrorGet(void);
+
 
 #ifdef __cplusplus // Provide C++ Compatibility
 }
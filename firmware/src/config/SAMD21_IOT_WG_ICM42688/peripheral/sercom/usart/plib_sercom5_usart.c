@@ -48,8 +48,10 @@
 // *****************************************************************************
 // *****************************************************************************
 
+#include <string.h>
 #include "interrupts.h"
 #include "plib_sercom5_usart.h"
+#include "peripheral/nvic/plib_nvic.h"
 
 // *****************************************************************************
 // *****************************************************************************
@@ -61,6 +63,8 @@
 /* SERCOM5 USART baud value for 115200 Hz baud rate */
 #define SERCOM5_USART_INT_BAUD_VALUE            (63019UL)
 
+static void SERCOM5_USART_DMA_Initialize(void);
+
 
 // *****************************************************************************
 // *****************************************************************************
@@ -130,6 +134,9 @@ void SERCOM5_USART_Initialize( void )
     {
         /* Do nothing */
     }
+
+    /* DMAC_Initialize() must have run before the transmit channel is claimed */
+    SERCOM5_USART_DMA_Initialize();
 }
 
 uint32_t SERCOM5_USART_FrequencyGet( void )
@@ -420,3 +427,290 @@ int SERCOM5_USART_ReadByte( void )
     return (int)SERCOM5_REGS->USART_INT.SERCOM_DATA;
 }
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: SERCOM5 USART DMA Implementation
+// *****************************************************************************
+// *****************************************************************************
+
+#define SERCOM5_USART_DMA_TX_CHANNEL    DMAC_CHANNEL_2
+
+/* Maximum block transfer count of a DMA descriptor */
+#define SERCOM5_USART_DMA_MAX_COUNT     (0xFFFFU)
+
+typedef struct
+{
+    /* Bytes copied into each packet buffer */
+    size_t                   count[2];
+
+    /* Spans queued behind each packet buffer */
+    uint8_t                  spanCount[2];
+
+    /* Vectored writes queued behind each packet buffer */
+    uint32_t                 writeVCount[2];
+
+    /* Vectored writes whose spans have all been sent */
+    uint32_t                 writeVComplete;
+
+    /* Packet buffer being filled, the DMA sends the other one */
+    uint8_t                  fillIndex;
+
+    bool                     transferIsBusy;
+
+    bool                     transferError;
+
+    SERCOM_USART_CALLBACK    callback;
+
+    uintptr_t                context;
+
+} SERCOM_USART_DMA_OBJECT;
+
+static volatile SERCOM_USART_DMA_OBJECT sercom5USARTDMAObj;
+
+static uint8_t sercom5USARTDMABuffer[2][SERCOM5_USART_DMA_BUFFER_SIZE];
+
+/* One descriptor per span, linked together when the packet buffer is sent */
+static dmac_descriptor_registers_t sercom5USARTDMASpanDesc[2][SERCOM5_USART_DMA_SPAN_MAX] __ALIGNED(16);
+
+/* Queue a span on the packet buffer being filled. Copied bytes that follow
+   copied bytes extend the previous span. Called with interrupts disabled. */
+static void SERCOM5_USART_DMA_SpanAppend(const SERCOM_USART_IOVEC *iov)
+{
+    uint8_t index = sercom5USARTDMAObj.fillIndex;
+    uint8_t span = sercom5USARTDMAObj.spanCount[index];
+    uint32_t srcAddr = (uint32_t)iov->base + iov->len;
+    dmac_descriptor_registers_t *desc;
+
+    if(iov->copy == true)
+    {
+        uint8_t *dst = &sercom5USARTDMABuffer[index][sercom5USARTDMAObj.count[index]];
+
+        (void) memcpy(dst, iov->base, iov->len);
+        sercom5USARTDMAObj.count[index] += iov->len;
+        srcAddr = (uint32_t)dst + iov->len;
+
+        if((span > 0U) && (sercom5USARTDMASpanDesc[index][span - 1U].DMAC_SRCADDR == (uint32_t)dst))
+        {
+            sercom5USARTDMASpanDesc[index][span - 1U].DMAC_BTCNT += (uint16_t)iov->len;
+            sercom5USARTDMASpanDesc[index][span - 1U].DMAC_SRCADDR = srcAddr;
+            return;
+        }
+    }
+
+    /* Incrementing addresses point at the end of the block */
+    desc = &sercom5USARTDMASpanDesc[index][span];
+    desc->DMAC_BTCTRL = (uint16_t)(DMAC_BTCTRL_VALID_Msk | DMAC_BTCTRL_BEATSIZE_BYTE
+                        | DMAC_BTCTRL_SRCINC_Msk | DMAC_BTCTRL_BLOCKACT_NOACT);
+    desc->DMAC_BTCNT = (uint16_t)iov->len;
+    desc->DMAC_SRCADDR = srcAddr;
+    desc->DMAC_DSTADDR = (uint32_t)&SERCOM5_REGS->USART_INT.SERCOM_DATA;
+    desc->DMAC_DESCADDR = 0U;
+
+    sercom5USARTDMAObj.spanCount[index] = span + 1U;
+}
+
+/* Send the spans queued on the packet buffer being filled and switch to the
+   other one. Called with interrupts disabled or from the DMAC interrupt. */
+static void SERCOM5_USART_DMA_TransferStart(void)
+{
+    uint8_t index = sercom5USARTDMAObj.fillIndex;
+    uint8_t last = sercom5USARTDMAObj.spanCount[index] - 1U;
+    uint8_t span;
+
+    for(span = 0U; span < last; span++)
+    {
+        sercom5USARTDMASpanDesc[index][span].DMAC_DESCADDR = (uint32_t)&sercom5USARTDMASpanDesc[index][span + 1U];
+    }
+
+    sercom5USARTDMASpanDesc[index][last].DMAC_BTCTRL |= (uint16_t)DMAC_BTCTRL_BLOCKACT_INT;
+
+    sercom5USARTDMAObj.fillIndex = index ^ 1U;
+    sercom5USARTDMAObj.count[index ^ 1U] = 0U;
+    sercom5USARTDMAObj.spanCount[index ^ 1U] = 0U;
+    sercom5USARTDMAObj.writeVCount[index ^ 1U] = 0U;
+    sercom5USARTDMAObj.transferIsBusy = true;
+
+    (void) DMAC_ChannelLinkedListTransfer(SERCOM5_USART_DMA_TX_CHANNEL, &sercom5USARTDMASpanDesc[index][0]);
+}
+
+static void SERCOM5_USART_DMA_TransferHandler(DMAC_TRANSFER_EVENT event, uintptr_t context)
+{
+    (void)context;
+
+    /* On error the rest of the packet buffer is dropped */
+    if(event == DMAC_TRANSFER_EVENT_ERROR)
+    {
+        sercom5USARTDMAObj.transferError = true;
+    }
+
+    /* In place spans of the buffer just sent can be reused by their owners */
+    sercom5USARTDMAObj.writeVComplete += sercom5USARTDMAObj.writeVCount[sercom5USARTDMAObj.fillIndex ^ 1U];
+    sercom5USARTDMAObj.transferIsBusy = false;
+
+    /* Chain the spans queued while this buffer was on the wire */
+    if(sercom5USARTDMAObj.spanCount[sercom5USARTDMAObj.fillIndex] > 0U)
+    {
+        SERCOM5_USART_DMA_TransferStart();
+    }
+
+    if(sercom5USARTDMAObj.callback != NULL)
+    {
+        sercom5USARTDMAObj.callback(sercom5USARTDMAObj.context);
+    }
+}
+
+static void SERCOM5_USART_DMA_Initialize(void)
+{
+    uint8_t index;
+
+    for(index = 0U; index < 2U; index++)
+    {
+        sercom5USARTDMAObj.count[index] = 0U;
+        sercom5USARTDMAObj.spanCount[index] = 0U;
+        sercom5USARTDMAObj.writeVCount[index] = 0U;
+    }
+
+    sercom5USARTDMAObj.writeVComplete = 0U;
+    sercom5USARTDMAObj.fillIndex = 0U;
+    sercom5USARTDMAObj.transferIsBusy = false;
+    sercom5USARTDMAObj.transferError = false;
+    sercom5USARTDMAObj.callback = NULL;
+
+    DMAC_ChannelCallbackRegister(SERCOM5_USART_DMA_TX_CHANNEL, SERCOM5_USART_DMA_TransferHandler, 0U);
+}
+
+void SERCOM5_USART_DMA_CallbackRegister( SERCOM_USART_CALLBACK callback, uintptr_t context )
+{
+    sercom5USARTDMAObj.callback = callback;
+    sercom5USARTDMAObj.context = context;
+}
+
+bool SERCOM5_USART_DMA_WriteV( const SERCOM_USART_IOVEC *iov, const size_t iovcnt )
+{
+    bool writeStatus = false;
+    bool interruptState;
+    size_t copySize = 0U;
+    size_t i;
+    uint8_t index;
+
+    if((iov == NULL) || (iovcnt == 0U) || (iovcnt > SERCOM5_USART_DMA_SPAN_MAX))
+    {
+        return false;
+    }
+
+    for(i = 0U; i < iovcnt; i++)
+    {
+        if((iov[i].base == NULL) || (iov[i].len == 0U) || (iov[i].len > SERCOM5_USART_DMA_MAX_COUNT))
+        {
+            return false;
+        }
+
+        if(iov[i].copy == true)
+        {
+            copySize += iov[i].len;
+        }
+    }
+
+    /* Keep the completion handler from switching buffers while appending */
+    interruptState = NVIC_INT_Disable();
+
+    index = sercom5USARTDMAObj.fillIndex;
+
+    /* Queue all of the spans or none of them */
+    if((copySize <= (SERCOM5_USART_DMA_BUFFER_SIZE - sercom5USARTDMAObj.count[index]))
+        && (iovcnt <= (size_t)(SERCOM5_USART_DMA_SPAN_MAX - sercom5USARTDMAObj.spanCount[index])))
+    {
+        for(i = 0U; i < iovcnt; i++)
+        {
+            SERCOM5_USART_DMA_SpanAppend(&iov[i]);
+        }
+
+        sercom5USARTDMAObj.writeVCount[index]++;
+
+        if(sercom5USARTDMAObj.transferIsBusy == false)
+        {
+            SERCOM5_USART_DMA_TransferStart();
+        }
+
+        writeStatus = true;
+    }
+
+    NVIC_INT_Restore(interruptState);
+
+    return writeStatus;
+}
+
+bool SERCOM5_USART_DMA_Write( void *buffer, const size_t size )
+{
+    bool writeStatus = false;
+    bool interruptState;
+    SERCOM_USART_IOVEC iov;
+    uint8_t index;
+
+    if((buffer == NULL) || (size == 0U) || (size > SERCOM5_USART_DMA_BUFFER_SIZE))
+    {
+        return false;
+    }
+
+    iov.base = buffer;
+    iov.len = size;
+    iov.copy = true;
+
+    interruptState = NVIC_INT_Disable();
+
+    index = sercom5USARTDMAObj.fillIndex;
+
+    /* Appending may need a new span even when it extends the last one */
+    if((size <= (SERCOM5_USART_DMA_BUFFER_SIZE - sercom5USARTDMAObj.count[index]))
+        && (sercom5USARTDMAObj.spanCount[index] < SERCOM5_USART_DMA_SPAN_MAX))
+    {
+        SERCOM5_USART_DMA_SpanAppend(&iov);
+
+        if(sercom5USARTDMAObj.transferIsBusy == false)
+        {
+            SERCOM5_USART_DMA_TransferStart();
+        }
+
+        writeStatus = true;
+    }
+
+    NVIC_INT_Restore(interruptState);
+
+    return writeStatus;
+}
+
+size_t SERCOM5_USART_DMA_WriteFreeBufferCountGet( void )
+{
+    size_t freeCount = 0U;
+    bool interruptState = NVIC_INT_Disable();
+    uint8_t index = sercom5USARTDMAObj.fillIndex;
+
+    if(sercom5USARTDMAObj.spanCount[index] < SERCOM5_USART_DMA_SPAN_MAX)
+    {
+        freeCount = SERCOM5_USART_DMA_BUFFER_SIZE - sercom5USARTDMAObj.count[index];
+    }
+
+    NVIC_INT_Restore(interruptState);
+
+    return freeCount;
+}
+
+uint32_t SERCOM5_USART_DMA_WriteVCompleteCountGet( void )
+{
+    return sercom5USARTDMAObj.writeVComplete;
+}
+
+bool SERCOM5_USART_DMA_IsBusy( void )
+{
+    return sercom5USARTDMAObj.transferIsBusy;
+}
+
+bool SERCOM5_USART_DMA_ErrorGet( void )
+{
+    bool transferError = sercom5USARTDMAObj.transferError;
+
+    sercom5USARTDMAObj.transferError = false;
+
+    return transferError;
+}
+
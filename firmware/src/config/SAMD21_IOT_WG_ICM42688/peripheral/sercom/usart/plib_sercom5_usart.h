@@ -52,6 +52,7 @@
 // *****************************************************************************
 
 #include "plib_sercom_usart_common.h"
+#include "peripheral/dmac/plib_dmac.h"
 
 // DOM-IGNORE-BEGIN
 #ifdef __cplusplus // Provide C++ Compatibility
@@ -67,6 +68,24 @@
 // *****************************************************************************
 // *****************************************************************************
 
+/* Size of each of the two DMA transmit packet buffers */
+#define SERCOM5_USART_DMA_BUFFER_SIZE   512U
+
+/* Maximum number of spans queued behind each packet buffer */
+#define SERCOM5_USART_DMA_SPAN_MAX      16U
+
+/* Span of a vectored write. Copied spans go into the packet buffer, other
+   spans are sent in place and must stay valid until the write completes. */
+typedef struct
+{
+    const void *base;
+
+    size_t len;
+
+    bool copy;
+
+} SERCOM_USART_IOVEC;
+
 void SERCOM5_USART_Initialize( void );
 
 bool SERCOM5_USART_SerialSetup( USART_SERIAL_SETUP * serialSetup, uint32_t clkFrequency );
@@ -99,6 +118,20 @@ USART_ERROR SERCOM5_USART_ErrorGet( void );
 
 uint32_t SERCOM5_USART_FrequencyGet( void );
 
+void SERCOM5_USART_DMA_CallbackRegister( SERCOM_USART_CALLBACK callback, uintptr_t context );
+
+bool SERCOM5_USART_DMA_Write( void *buffer, const size_t size );
+
+bool SERCOM5_USART_DMA_WriteV( const SERCOM_USART_IOVEC *iov, const size_t iovcnt );
+
+size_t SERCOM5_USART_DMA_WriteFreeBufferCountGet( void );
+
+uint32_t SERCOM5_USART_DMA_WriteVCompleteCountGet( void );
+
+bool SERCOM5_USART_DMA_IsBusy( void );
+
+bool SERCOM5_USART_DMA_ErrorGet( void );
+
 // DOM-IGNORE-BEGIN
 #ifdef __cplusplus  // Provide C++ Compatibility
 
@@ -0,0 +1,138 @@
+/*******************************************************************************
+  Delta Codec Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    deltacodec.c
+
+  Summary:
+    This file contains the lossless packet codec used by the compressed stream
+ *******************************************************************************/
+/*******************************************************************************
+* Copyright (C) 2020 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include "deltacodec.h"
+
+/* Map signed values onto unsigned so small magnitudes of either sign stay small */
+static inline uint16_t zigzag16(int16_t value) {
+    return (uint16_t) (((uint16_t) value << 1) ^ (uint16_t) (value >> 15));
+}
+
+/* Seven bits per byte, least significant first, top bit set on all but the last */
+static inline uint8_t * varint16(uint8_t *dst, uint16_t value) {
+    while (value >= 0x80U) {
+        *dst++ = (uint8_t) (value | 0x80U);
+        value >>= 7;
+    }
+    *dst++ = (uint8_t) value;
+    return dst;
+}
+
+int8_t deltacodec_init(delta_codec_t *codec, int16_t *prev, uint8_t columns, uint16_t keyframe_interval) {
+    if (prev == NULL || columns == 0 || keyframe_interval == 0)
+        return -1;
+
+    codec->prev = prev;
+    codec->columns = columns;
+    codec->seqnum = 0;
+    codec->keyframe_interval = keyframe_interval;
+    memset(prev, 0, columns * sizeof(*prev));
+    deltacodec_reset(codec);
+    
+    return 0;
+}
+
+void deltacodec_reset(delta_codec_t *codec) {
+    codec->keyframe_countdown = 0;
+}
+
+size_t deltacodec_encode(const delta_codec_t *codec, const int16_t *frames, uint8_t nframes, uint8_t *dst) {
+    const int16_t *prev = codec->prev;
+    uint8_t *payload = dst + DELTACODEC_HEADER_LEN;
+    uint8_t *ptr = payload;
+    uint8_t check = 0;
+    size_t length;
+    
+    dst[0] = DELTACODEC_START_OF_FRAME;
+    dst[1] = codec->seqnum & DELTACODEC_SEQNUM_MASK;
+    dst[2] = codec->columns;
+    dst[3] = nframes;
+    
+    /* Keyframes code their first frame against zero, i.e. raw */
+    if (codec->keyframe_countdown == 0) {
+        dst[1] |= DELTACODEC_FLAG_KEYFRAME;
+        for (int j = 0; j < codec->columns; j++) {
+            ptr = varint16(ptr, zigzag16(frames[j]));
+        }
+        prev = frames;
+        frames += codec->columns;
+        nframes--;
+    }
+    
+    while (nframes--) {
+        for (int j = 0; j < codec->columns; j++) {
+            /* Deltas wrap at 16 bits so every column round trips exactly */
+            ptr = varint16(ptr, zigzag16((int16_t) (uint16_t) (frames[j] - prev[j])));
+        }
+        prev = frames;
+        frames += codec->columns;
+    }
+    
+    length = ptr - payload;
+    dst[4] = (uint8_t) length;
+    dst[5] = (uint8_t) (length >> 8);
+    for (uint8_t const *p = dst + 1; p < ptr; p++) {
+        check ^= *p;
+    }
+    *ptr++ = check;
+    
+    return ptr - dst;
+}
+
+void deltacodec_commit(delta_codec_t *codec, const int16_t *frames, uint8_t nframes) {
+    memcpy(codec->prev, frames + (nframes - 1) * codec->columns, codec->columns * sizeof(*frames));
+    codec->seqnum = (codec->seqnum + 1) & DELTACODEC_SEQNUM_MASK;
+    if (codec->keyframe_countdown == 0)
+        codec->keyframe_countdown = codec->keyframe_interval;
+    codec->keyframe_countdown--;
+}
+
+size_t deltacodec_encode_gap(uint32_t lost, uint8_t position, uint8_t *dst) {
+    uint8_t check = 0;
+    
+    dst[0] = DELTACODEC_GAP_RECORD;
+    dst[1] = (uint8_t) lost;
+    dst[2] = (uint8_t) (lost >> 8);
+    dst[3] = (uint8_t) (lost >> 16);
+    dst[4] = (uint8_t) (lost >> 24);
+    dst[5] = position;
+    for (int i = 1; i < DELTACODEC_GAP_LEN - 1; i++) {
+        check ^= dst[i];
+    }
+    dst[DELTACODEC_GAP_LEN - 1] = check;
+    
+    return DELTACODEC_GAP_LEN;
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+  Delta Codec Interface Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    deltacodec.h
+
+  Summary:
+    This file contains the lossless packet codec used by the compressed stream
+
+  Notes:
+    - Each value is sent as the difference from the same column of the previous
+      frame, zigzag mapped and varint coded, so a sensor at rest costs about a
+      byte per value. Keyframes carry raw values so a host can join or recover
+      part way through a stream.
+    - Packet layout (multi-byte fields little endian):
+        start       DELTACODEC_START_OF_FRAME
+        flags       bit 7 set on keyframes, bits 6..0 packet sequence number
+        columns     values per frame
+        frames      frames in the packet
+        length      payload bytes, 16 bits
+        payload     frames x columns varints; the first value of each column
+                    in a keyframe is raw, all others are deltas
+        check       XOR of flags through payload
+    - Gap record, sent where the firmware had to drop samples:
+        start       DELTACODEC_GAP_RECORD
+        lost        samples dropped, 32 bits
+        position    frames of the next packet that come before the gap
+        check       XOR of lost and position
+ *******************************************************************************/
+/*******************************************************************************
+* Copyright (C) 2020 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *******************************************************************************/
+#ifndef DELTACODEC_H
+#define	DELTACODEC_H
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#define DELTACODEC_START_OF_FRAME   0xA6U
+#define DELTACODEC_FLAG_KEYFRAME    0x80U
+#define DELTACODEC_SEQNUM_MASK      0x7FU
+#define DELTACODEC_HEADER_LEN       6
+#define DELTACODEC_TRAILER_LEN      1
+#define DELTACODEC_GAP_RECORD       0xA7U
+#define DELTACODEC_GAP_LEN          7
+
+/* Longest varint of a 16 bit value */
+#define DELTACODEC_VARINT_MAX       3
+
+/* Buffer size that holds any packet of frames x columns values */
+#define DELTACODEC_PACKET_MAXLEN(frames, columns) \
+    (DELTACODEC_HEADER_LEN + (frames) * (columns) * DELTACODEC_VARINT_MAX + DELTACODEC_TRAILER_LEN)
+
+typedef struct delta_codec {
+    int16_t *prev;                  // last frame sent, columns long
+    uint8_t columns;
+    uint8_t seqnum;
+    uint16_t keyframe_interval;     // packets from one keyframe to the next
+    uint16_t keyframe_countdown;    // packets until the next keyframe, 0 => now
+} delta_codec_t;
+
+/* prev must hold a frame of columns values; the first packet is a keyframe.
+ * Return non-zero on error */
+int8_t deltacodec_init(delta_codec_t *codec, int16_t *prev, uint8_t columns, uint16_t keyframe_interval);
+
+/* Make the next packet a keyframe, e.g. after frames have been dropped */
+void deltacodec_reset(delta_codec_t *codec);
+
+/* Encode nframes (at least 1) consecutive frames into dst, which must hold
+ * DELTACODEC_PACKET_MAXLEN(nframes, columns) bytes (at most 64kB of payload).
+ * Returns the packet length.
+ * The codec is left untouched so the packet may be discarded; call
+ * deltacodec_commit once it has been sent
+ */
+size_t deltacodec_encode(const delta_codec_t *codec, const int16_t *frames, uint8_t nframes, uint8_t *dst);
+
+/* Move the codec on past a packet encoded from frames */
+void deltacodec_commit(delta_codec_t *codec, const int16_t *frames, uint8_t nframes);
+
+/* Encode a gap record into dst, which must hold DELTACODEC_GAP_LEN bytes.
+ * Returns the record length. The deltas run on across a gap, so the codec
+ * is not involved */
+size_t deltacodec_encode_gap(uint32_t lost, uint8_t position, uint8_t *dst);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* DELTACODEC_H */
@@ -27,12 +27,22 @@
 #include <stdint.h>
 #include <stdlib.h>                     // Defines EXIT_FAILURE
 #include <stdio.h>
+#include <stdarg.h>
 #include "ringbuffer.h"
 #include "sensor.h"
 #include "app_config.h"
 #if STREAM_FORMAT_IS(SMLSS)
 #include "ssi_comms.h"
 #endif //STREAM_FORMAT_IS(SMLSS)
+#if STREAM_FORMAT_IS(COMPRESSED)
+#include "deltacodec.h"
+#endif //STREAM_FORMAT_IS(COMPRESSED)
+#if STREAM_FORMAT_IS(COBS) || STREAM_FORMAT_IS(SMLSS)
+#include "crc16.h"
+#endif
+#if STREAM_FORMAT_IS(COBS)
+#include "cobs.h"
+#endif //STREAM_FORMAT_IS(COBS)
 // *****************************************************************************
 // *****************************************************************************
 // Section: Platform specific includes
@@ -48,33 +58,231 @@
 
 /* Must be large enough to hold the connect/disconnect strings from SensiML DCL */
 #define UART_RXBUF_LEN  128
-static uint8_t _uartRxBuffer_data[UART_RXBUF_LEN];
-static ringbuffer_t uartRxBuffer;
+RINGBUFFER_DEFINE(uart_rx, uint8_t, UART_RXBUF_LEN)
+static uart_rx_ringbuffer_t uartRxBuffer;
+
+/* Longest ASCII line: sign and 5 digits per axis, 10 digit timestamp, separators and newline */
+#define ASCII_LINE_LEN  (SNSR_NUM_AXES * 7 + (SNSR_USE_TIMESTAMP ? 11 : 0) + 2)
+
+/* Most ASCII lines rendered for a single UART write */
+#define ASCII_BATCH_FRAMES  8
+
+#if STREAM_FORMAT_IS(SMLSS)
+/* Channels of the SensiML stream; the samples all go on channel 0 unless
+ * SSI_MULTI_CHANNEL spreads them out */
+#define SSI_CHANNEL_ACCEL   0
+#define SSI_CHANNEL_GYRO    1
+#define SSI_CHANNEL_TEMP    2
+#define SSI_CHANNEL_EVENT   3
+
+/* Event codes, published on SSI_CHANNEL_EVENT with a value and the time */
+#define SSI_EVENT_OVERRUN   1   // buffered samples were discarded
+#define SSI_EVENT_BAUD      2   // the link changed rate, value is the baud rate / 100
+#define SSI_EVENT_GAP       3   // samples were dropped, value is how many (up to INT16_MAX per event)
+
+/* Packet columns: the IMU channels carry three axes and the temperature
+ * channel one value, each with the sample timestamp if enabled; events always
+ * carry the time they were raised */
+#define SSI_IMU_COLUMNS     (3 + SNSR_TIMESTAMP_WORDS)
+#define SSI_TEMP_COLUMNS    (1 + SNSR_TIMESTAMP_WORDS)
+#define SSI_EVENT_TIMESTAMP_WORDS   (sizeof(uint32_t) / sizeof(snsr_data_t))
+#define SSI_EVENT_COLUMNS   (2 + SSI_EVENT_TIMESTAMP_WORDS)
+#define SSI_PACKET_LEN(columns, samples)    (SSI_HEADER_SIZE + (columns) * (samples) * sizeof(snsr_data_t) + SSI_CHECKSUM_SIZE)
+#endif
+
+/* Bytes on the wire for one streamed packet */
+#if STREAM_FORMAT_IS(MDV)
+#define STREAM_PACKET_LEN   (sizeof(snsr_datapacket_t) + (MDV_USE_FRAME_COUNTER ? 4 : 2))
+#elif STREAM_FORMAT_IS(SMLSS) && SSI_MULTI_CHANNEL
+/* An accelerometer packet, and the share of gyroscope packets that the same
+ * frames make at the decimated rate; the temperature and event channels are
+ * too slow to count */
+#define SSI_GYRO_FRAMES_PER_PACKET  (SSI_GYRO_DECIMATION * SSI_GYRO_SAMPLES_PER_PACKET)
+#define STREAM_PACKET_LEN   (SNSR_USE_ACCEL * SSI_PACKET_LEN(SSI_IMU_COLUMNS, SNSR_SAMPLES_PER_PACKET) \
+                            + SNSR_USE_GYRO * (SSI_PACKET_LEN(SSI_IMU_COLUMNS, SSI_GYRO_SAMPLES_PER_PACKET) * SNSR_SAMPLES_PER_PACKET \
+                                + SSI_GYRO_FRAMES_PER_PACKET - 1) / SSI_GYRO_FRAMES_PER_PACKET)
+#elif STREAM_FORMAT_IS(SMLSS) && (SSI_JSON_CONFIG_VERSION >= 2)
+#define STREAM_PACKET_LEN   (SSI_HEADER_SIZE + sizeof(snsr_datapacket_t) + SSI_CHECKSUM_SIZE)
+#elif STREAM_FORMAT_IS(SMLSS)
+#define STREAM_PACKET_LEN   (sizeof(snsr_datapacket_t))
+#elif STREAM_FORMAT_IS(COMPRESSED)
+/* Budgeted as if uncompressed: at rest a value codes in about one byte rather
+ * than two, which leaves the queue room to absorb bursts of motion */
+#define STREAM_PACKET_LEN   (DELTACODEC_HEADER_LEN + sizeof(snsr_datapacket_t) + DELTACODEC_TRAILER_LEN)
+#define COMPRESSED_PACKET_MAXLEN    DELTACODEC_PACKET_MAXLEN(SNSR_SAMPLES_PER_PACKET, SNSR_NUM_COLUMNS)
+#elif STREAM_FORMAT_IS(COBS)
+/* Frame counter, samples and CRC-16, stuffed and delimited */
+#define COBS_PACKET_LEN     (sizeof(uint16_t) + sizeof(snsr_datapacket_t) + sizeof(uint16_t))
+#define STREAM_PACKET_LEN   COBS_ENCODED_MAXLEN(COBS_PACKET_LEN)
+#else
+#define STREAM_PACKET_LEN   ASCII_LINE_LEN
+#endif
+
+/* Link budget: bytes per second the stream needs, and those the UART may carry
+ * at a baud rate (10 bits per byte: start bit, 8 data bits and stop bit) */
+#define STREAM_BYTES_PER_SEC    (((uint64_t) SNSR_SAMPLE_RATE * STREAM_PACKET_LEN + SNSR_SAMPLES_PER_PACKET - 1) / SNSR_SAMPLES_PER_PACKET)
+#define UART_LINK_BUDGET(baud)  ((uint64_t) (baud) * UART_LINK_MAX_LOAD / 1000U)
+
+#if !STREAM_FORMAT_IS(NONE)
+_Static_assert(STREAM_BYTES_PER_SEC <= UART_LINK_BUDGET(UART_BAUD_MAX),
+        "stream does not fit the UART even at UART_BAUD_MAX, lower SNSR_SAMPLE_RATE");
+#endif
 
-static volatile uint32_t tickcounter = 0;
-static volatile unsigned int tickrate = 0;
+/* Host commands: baud rate negotiation, see baud_task, and buffer status, see status_task */
+#define BAUD_CMD            "baud "
+#define BAUD_CMD_CHARS      5
+#define STATUS_CMD          "status"
+#define STATUS_CMD_CHARS    6
+#define HOST_CMD_MAXLEN     20
+
+typedef enum {
+    BAUD_STATE_IDLE = 0,
+    BAUD_STATE_DRAIN,       // ack queued, switch once it has been sent
+    BAUD_STATE_CONFIRM      // switched, waiting for the host at the new rate
+} baud_state_t;
+
+static uint32_t uart_baud = UART_BAUD_DEFAULT;
+static baud_state_t baud_state = BAUD_STATE_IDLE;
+static uint32_t baud_requested = 0;
+static uint64_t baud_deadline_ms = 0;
+static bool uart_rx_held = false;
+
+/* Set while the stream fits the link budget at the current baud rate */
+static bool stream_admitted = false;
+
+/* Upper bits of the microsecond clock, counted by the timer overflow interrupt */
+static volatile uint64_t timer_overflows = 0;
+static unsigned int tickrate = 0;
 
 static struct sensor_device_t sensor;
-static snsr_data_t _snsr_buffer_data[SNSR_BUF_LEN][SNSR_NUM_AXES];
-static ringbuffer_t snsr_buffer;
+static snsr_ringbuffer_t snsr_buffer;
 static volatile bool snsr_buffer_overrun = false;
 
+/* Samples of packets the UART is sending in place, released once the write completes */
+static ringbuffer_size_t snsr_tx_inflight = 0;
+static uint32_t snsr_tx_completed = 0;
+
+#if RINGBUFFER_STATS
+/* Occupancy telemetry since power up, reported on the status command */
+static ringbuffer_stats_t snsr_buffer_stats;
+static ringbuffer_stats_t uart_rx_stats;
+static bool status_requested = false;
+#endif
+
+/* Rolling count of the frames streamed, for formats that number them */
+#define STREAM_USE_FRAME_COUNTER    ((STREAM_FORMAT_IS(MDV) && MDV_USE_FRAME_COUNTER) || STREAM_FORMAT_IS(COBS))
+#if STREAM_USE_FRAME_COUNTER
+static uint16_t stream_frame_counter = 0;
+#endif
+
+#if STREAM_FORMAT_IS(COMPRESSED)
+_Static_assert(sizeof(snsr_data_t) == sizeof(int16_t), "the compressed stream codes 16 bit samples");
+static snsr_dataframe_t compressed_prev;
+static delta_codec_t compressed_codec;
+#endif
+
+#if STREAM_FORMAT_IS(SMLSS) && SSI_MULTI_CHANNEL
+/* Accelerometer and gyroscope channels, each filling its own packet from the
+ * columns of the sample frames. A channel at a lower rate averages each run of
+ * decimation frames into one sample, stamped with the time of the first */
+#define SSI_IMU_PACKET_MAX  ((SNSR_SAMPLES_PER_PACKET > SSI_GYRO_SAMPLES_PER_PACKET) ? SNSR_SAMPLES_PER_PACKET : SSI_GYRO_SAMPLES_PER_PACKET)
+
+typedef struct {
+    uint8_t channel;
+    uint8_t offset;         // first column taken from the sample frame
+    uint8_t decimation;     // frames averaged into each sample
+    uint8_t samples_per_packet;
+    uint8_t phase;          // frames summed into the sample being built
+    uint8_t count;          // samples in the packet
+    int32_t sum[3];
+    snsr_data_t packet[SSI_IMU_PACKET_MAX][SSI_IMU_COLUMNS];
+} ssi_imu_channel_t;
+
+static ssi_imu_channel_t ssi_imu_channels[] = {
+#if SNSR_USE_ACCEL
+    { SSI_CHANNEL_ACCEL, 0, 1, SNSR_SAMPLES_PER_PACKET },
+#endif
+#if SNSR_USE_GYRO
+    { SSI_CHANNEL_GYRO, 3 * SNSR_USE_ACCEL, SSI_GYRO_DECIMATION, SSI_GYRO_SAMPLES_PER_PACKET },
+#endif
+};
+#define SSI_IMU_CHANNELS    (sizeof(ssi_imu_channels) / sizeof(ssi_imu_channels[0]))
+
+_Static_assert(sizeof(ssi_imu_channels[0].packet) <= SSI_COPY_MAX_SIZE,
+        "SSI channel packet too long, lower SNSR_SAMPLES_PER_PACKET or SSI_GYRO_SAMPLES_PER_PACKET");
+
+static uint64_t ssi_temp_due_ms = 0;
+#endif
+
+#if SNSR_OVERRUN_CONTINUOUS
+/* A run of samples dropped for want of buffer space, after index frames had
+ * been buffered; frames are counted from the start, wrapping at 32 bits */
+typedef struct {
+    uint32_t index;
+    uint32_t lost;
+    uint32_t time_us;
+} snsr_gap_t;
+
+/* Gaps waiting for the streamer to reach them */
+#define SNSR_GAP_QUEUE_LEN  4
+RINGBUFFER_DEFINE(snsr_gap, snsr_gap_t, SNSR_GAP_QUEUE_LEN)
+static snsr_gap_ringbuffer_t snsr_gaps;
+
+/* Gap still growing, queued once a frame has been buffered after it */
+static snsr_gap_t snsr_gap_open;
+static volatile uint32_t snsr_frames_in = 0;
+
+/* Frames handed to the streamer, and the gap it is reporting */
+static uint32_t stream_frames_out = 0;
+static snsr_gap_t stream_gap;
+#endif
+
+/* Sensor read requests queued by the data ready ISR and serviced from the main loop */
+static volatile uint8_t snsr_read_requests = 0;
+static uint8_t snsr_read_serviced = 0;
+static volatile uint64_t snsr_read_timestamp_us = 0;
+static volatile bool snsr_read_busy = false;
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Platform specific stub definitions
 // *****************************************************************************
 // *****************************************************************************
 void SERCOM5_Handler() {
-    ringbuffer_size_t rdcnt;
-    uint8_t *ptr = ringbuffer_get_write_buffer(&uartRxBuffer, &rdcnt);
-    if (UART_IsRxReady() && rdcnt) {
-        *ptr = UART_RX_DATA;
-        ringbuffer_advance_write_index(&uartRxBuffer, 1);
+    if (UART_IsRxReady()) {
+        /* Reading the data clears the interrupt; a byte that finds the buffer
+         * full is dropped (and counted as an overrun) */
+        uint8_t data = UART_RX_DATA;
+        uart_rx_ringbuffer_push(&uartRxBuffer, &data);
     }
 }
 
+/* Queues the bytes for DMA transmission and returns at once; nothing is
+ * queued if the whole write does not fit */
 size_t __attribute__(( unused )) UART_Write(uint8_t *ptr, const size_t nbytes) {
-    return SERCOM5_USART_Write(ptr, nbytes) ? nbytes : 0;
+    return SERCOM5_USART_DMA_Write(ptr, nbytes) ? nbytes : 0;
+}
+
+/* Reprograms the link; the transmit queue should be empty */
+static bool UART_BaudSet(uint32_t baud) {
+    USART_SERIAL_SETUP setup = { baud, USART_PARITY_NONE, USART_DATA_8_BIT, USART_STOP_1_BIT };
+    return UART_SerialSetup(&setup);
+}
+
+/* Queues all the spans as one transmission, or nothing if they do not fit */
+size_t __attribute__(( unused )) UART_WriteV(const uart_iovec_t *iov, const int iovcnt) {
+    SERCOM_USART_IOVEC spans[SERCOM5_USART_DMA_SPAN_MAX];
+    size_t nbytes = 0;
+
+    if (iovcnt <= 0 || iovcnt > (int) SERCOM5_USART_DMA_SPAN_MAX)
+        return 0;
+    for (int i = 0; i < iovcnt; i++) {
+        spans[i].base = iov[i].base;
+        spans[i].len = iov[i].len;
+        spans[i].copy = iov[i].copy;
+        nbytes += iov[i].len;
+    }
+    return SERCOM5_USART_DMA_WriteV(spans, iovcnt) ? nbytes : 0;
 }
 
 // *****************************************************************************
@@ -87,90 +295,889 @@ void Null_Handler() {
 }
 
 size_t __attribute__(( unused )) UART_Read(uint8_t *ptr, const size_t nbytes) {
-    return ringbuffer_read(&uartRxBuffer, ptr, nbytes);
+    return uart_rx_ringbuffer_read(&uartRxBuffer, ptr, nbytes);
+}
+
+static void Timer_Overflow_Callback() {
+    timer_overflows++;
 }
 
-static void Ticker_Callback() {
-    static uint32_t mstick = 0;
+uint64_t read_timer_us(void) {
+    uint64_t high;
+    uint16_t count;
+    
+    /* Safe to call from any context: an overflow the interrupt handler has not
+     * counted yet (masked here, or preempted by the caller) is accounted for
+     * unless the count was read just before the wrap */
+    bool interruptState = NVIC_INT_Disable();
+    high = timer_overflows;
+    count = TC_TimerGet_us();
+    if (TC_TimerOverflowPending() && count < (1U << (TC_TIMER_BITS - 1)))
+        high++;
+    NVIC_INT_Restore(interruptState);
+    
+    return (high << TC_TIMER_BITS) | count;
+}
 
-    ++tickcounter;
-    if (tickrate == 0 || mstick > tickrate) {
-        mstick = 0;
-    }
-    else if (++mstick == tickrate) {
-        LED_STATUS_Toggle();
-        mstick = 0;
-    }
+// Get the time of the last sensor interrupt edge, latched in hardware by the timer
+static uint64_t read_capture_us(void) {
+    uint64_t now;
+    uint16_t capture;
+    
+    bool interruptState = NVIC_INT_Disable();
+    now = read_timer_us();
+    capture = TC_TimerCaptureGet_us();
+    NVIC_INT_Restore(interruptState);
+    
+    /* The edge is less than one counter period old so extend it from the current time */
+    return now - (uint16_t) ((uint16_t) now - capture);
 }
 
 uint64_t read_timer_ms(void) {
-    return tickcounter;
+    return read_timer_us() / 1000U;
 }
 
-uint64_t read_timer_us(void) {
-    return tickcounter * 1000U + (uint32_t) TC_TimerGet_us();
+#if RINGBUFFER_STATS
+// Time source of the buffer telemetry, in ticks of 1024us so that the sample
+// ISRs that stamp it need no 64-bit division; wraps every 50 days
+static uint32_t stats_clock(void) {
+    return (uint32_t) (read_timer_us() >> 10);
 }
+#endif
 
 void sleep_ms(uint32_t ms) {
-    uint32_t t0 = read_timer_ms();
+    uint64_t t0 = read_timer_ms();
     while ((read_timer_ms() - t0) < ms) { };
 }
 
 void sleep_us(uint32_t us) {
-    uint32_t t0 = read_timer_us();
+    uint64_t t0 = read_timer_us();
     while ((read_timer_us() - t0) < us) { };
 }
 
-// For handling read of the sensor data
+// Blink the status LED at tickrate from the main loop
+static void Ticker_Task() {
+    static uint32_t t0 = 0;
+    uint32_t now = (uint32_t) read_timer_ms();
+
+    if (tickrate == 0) {
+        t0 = now;
+    }
+    else if ((now - t0) >= tickrate) {
+        LED_STATUS_Toggle();
+        t0 = now;
+    }
+}
+
+// For handling the sensor data ready interrupt
 void SNSR_ISR_HANDLER() {
+    /* Fetch the sample time captured at the edge and defer the bus transfer to snsr_read_task */
+    snsr_read_timestamp_us = read_capture_us();
+    snsr_read_requests++;
+}
+
+#if !SNSR_USE_FIFO
+// For handling completion of an asynchronous sensor read
+static void snsr_read_complete(struct sensor_device_t *sensor) {
+    if (sensor->status == SNSR_STATUS_OK) {
+        snsr_ringbuffer_advance_write_index(&snsr_buffer, 1);
+#if SNSR_OVERRUN_CONTINUOUS
+        snsr_frames_in++;
+#endif
+    }
+    snsr_read_busy = false;
+}
+#endif
+
+#if SNSR_OVERRUN_CONTINUOUS
+// Queue the open gap once frames have been buffered after it; should the
+// queue be full it stays open and takes in later losses too
+static void snsr_gap_close() {
+    if (snsr_gap_open.lost && snsr_gap_open.index != snsr_frames_in
+            && snsr_gap_ringbuffer_push(&snsr_gaps, &snsr_gap_open))
+        snsr_gap_open.lost = 0;
+}
+#endif
+
+// Account for count samples that were lost for want of buffer space. Returns
+// true if acquisition carries on, false if it stops for the overrun handler
+static bool snsr_samples_lost(ringbuffer_size_t count) {
+    snsr_ringbuffer_count_overrun(&snsr_buffer, count);
+#if SNSR_OVERRUN_CONTINUOUS
+    if (snsr_gap_open.lost == 0) {
+        snsr_gap_open.index = snsr_frames_in;
+        snsr_gap_open.time_us = (uint32_t) read_timer_us();
+    }
+    snsr_gap_open.lost += count;
+    return true;
+#else
+    snsr_buffer_overrun = true;
+    return false;
+#endif
+}
+
+// For handling read of the sensor data
+static void snsr_read_task() {
+    uint8_t requests = snsr_read_requests;
+    
+    /* Wait for the previous transfer to finish */
+    if (requests == snsr_read_serviced || snsr_read_busy)
+        return;
+    
     /* Check if any errors we've flagged have been acknowledged */
     if ((sensor.status != SNSR_STATUS_OK) || snsr_buffer_overrun)
         return;
     
-    ringbuffer_size_t wrcnt;
-    snsr_data_t *ptr = ringbuffer_get_write_buffer(&snsr_buffer, &wrcnt);
+#if SNSR_OVERRUN_CONTINUOUS
+    snsr_gap_close();
+#endif
+#if SNSR_USE_FIFO
+    /* Drain the sensor FIFO straight into the buffer in a single burst */
+    ringbuffer_size_t dropped;
+    #if SNSR_OVERRUN_CONTINUOUS
+    ringbuffer_size_t space = snsr_ringbuffer_get_write_items(&snsr_buffer);
+    #endif
+    
+    snsr_read_serviced = requests;
+    sensor.status = sensor_read_fifo(&sensor, &snsr_buffer, &dropped);
+    #if SNSR_OVERRUN_CONTINUOUS
+    snsr_frames_in += space - snsr_ringbuffer_get_write_items(&snsr_buffer);
+    #endif
+    if (sensor.status == SNSR_STATUS_OK && dropped)
+        snsr_samples_lost(dropped);
+#else
+    snsr_dataframe_t *slot = snsr_ringbuffer_get_write_slot(&snsr_buffer);
+    uint8_t overtaken = (uint8_t) (requests - snsr_read_serviced) - 1;
+    
+    /* More than one outstanding request means samples were overwritten before they were read */
+    bool carry_on = (overtaken == 0) || snsr_samples_lost(overtaken);
+    
+    if (carry_on && slot == NULL)
+        snsr_samples_lost(1);
+    else if (carry_on) {
+        /* Fall back on the captured interrupt edge for sensors that don't timestamp samples */
+        snsr_set_timestamp(*slot, (uint32_t) snsr_read_timestamp_us);
+        
+        /* The frame is committed by snsr_read_complete once the transfer is done */
+        snsr_read_busy = true;
+        if (sensor_read_async(&sensor, *slot, snsr_read_complete) != SNSR_STATUS_OK)
+            snsr_read_busy = false;
+    }
+    snsr_read_serviced = requests;
+#endif
+}
+
+// Release the samples of packets the UART has finished sending in place
+static void snsr_tx_release() {
+    uint32_t completed = UART_WriteVCompleteCountGet();
+    ringbuffer_size_t released = (ringbuffer_size_t) (completed - snsr_tx_completed) * SNSR_SAMPLES_PER_PACKET;
+
+    snsr_tx_completed = completed;
+    snsr_tx_inflight -= snsr_ringbuffer_advance_read_index(&snsr_buffer, released);
+}
+
+#if STREAM_FORMAT_IS(SMLSS) && SSI_MULTI_CHANNEL
+// Drop the samples collected in the channel packets
+static void ssi_channels_reset() {
+    for (size_t i=0; i < SSI_IMU_CHANNELS; i++) {
+        ssi_imu_channels[i].count = 0;
+        ssi_imu_channels[i].phase = 0;
+        memset(ssi_imu_channels[i].sum, 0, sizeof(ssi_imu_channels[i].sum));
+    }
+}
+#endif
+
+// Discard sensor data that has been buffered or requested
+static void snsr_buffer_reset() {
+    MIKRO_INT_CallbackRegister(Null_Handler);
+    while (snsr_read_busy) { };
+    
+    /* Let the UART finish with any samples it is still sending */
+    while (UART_TxIsBusy()) { };
+    snsr_tx_completed = UART_WriteVCompleteCountGet();
+    snsr_tx_inflight = 0;
+    
+    snsr_ringbuffer_reset(&snsr_buffer);
+#if STREAM_USE_FRAME_COUNTER
+    /* Leave a gap in the count where samples were discarded */
+    stream_frame_counter++;
+#endif
+#if STREAM_FORMAT_IS(COMPRESSED)
+    deltacodec_reset(&compressed_codec);
+#endif
+#if STREAM_FORMAT_IS(SMLSS) && SSI_MULTI_CHANNEL
+    ssi_channels_reset();
+#endif
+#if SNSR_OVERRUN_CONTINUOUS
+    /* Nothing before the reset is left to report */
+    snsr_gap_ringbuffer_reset(&snsr_gaps);
+    snsr_gap_open.lost = 0;
+    stream_gap.lost = 0;
+    stream_frames_out = snsr_frames_in;
+#endif
+#if SNSR_USE_FIFO
+    sensor_flush_fifo(&sensor);
+#endif
+    snsr_read_serviced = snsr_read_requests;
+    snsr_buffer_overrun = false;
+    MIKRO_INT_CallbackRegister(SNSR_ISR_HANDLER);
+}
+
+#if STREAM_FORMAT_IS(ASCII)
+// Render value in decimal at dst, returning the number of characters. Division
+// is a library call on the Cortex-M0+, so divide by 10 with a multiply and a
+// shift instead (exact for all 16 bit values)
+static inline size_t ascii_put_u16(char *dst, uint16_t value) {
+    char digits[5];
+    size_t n = 0, len;
+    
+    do {
+        uint16_t quotient = (uint16_t) (((uint32_t) value * 52429U) >> 19);
+        digits[n++] = (char) ('0' + (value - quotient * 10U));
+        value = quotient;
+    } while (value);
+    for (len = n; n; ) {
+        *dst++ = digits[--n];
+    }
+    return len;
+}
+
+static inline size_t ascii_put_i16(char *dst, int16_t value) {
+    if (value < 0) {
+        *dst = '-';
+        return 1 + ascii_put_u16(dst + 1, (uint16_t) -value);
+    }
+    return ascii_put_u16(dst, (uint16_t) value);
+}
+
+#if SNSR_USE_TIMESTAMP
+// As ascii_put_u16 for 32 bit values, counting down through the powers of ten
+static size_t ascii_put_u32(char *dst, uint32_t value) {
+    static const uint32_t powers[] = { 1000000000UL, 100000000UL, 10000000UL, 1000000UL,
+                                       100000UL, 10000UL, 1000UL, 100UL, 10UL };
+    char *start = dst;
+    size_t i = 0;
+    
+    while (i < sizeof(powers) / sizeof(powers[0]) && value < powers[i]) {
+        i++;
+    }
+    for (; i < sizeof(powers) / sizeof(powers[0]); i++) {
+        char digit = '0';
+        while (value >= powers[i]) {
+            value -= powers[i];
+            digit++;
+        }
+        *dst++ = digit;
+    }
+    *dst++ = (char) ('0' + value);
+    return dst - start;
+}
+#endif
+
+// Render nframes frames as lines of space separated values into dst, which
+// must hold nframes * ASCII_LINE_LEN characters; returns the length
+static size_t ascii_format_frames(char *dst, snsr_dataframe_t const *ptr, ringbuffer_size_t nframes) {
+    char *start = dst;
+    
+    while (nframes--) {
+        snsr_data_t const *scalarptr = *ptr;
+        dst += ascii_put_i16(dst, *scalarptr++);
+        for (int j=1; j < SNSR_NUM_AXES; j++) {
+            *dst++ = ' ';
+            dst += ascii_put_i16(dst, *scalarptr++);
+        }
+#if SNSR_USE_TIMESTAMP
+        *dst++ = ' ';
+        dst += ascii_put_u32(dst, snsr_get_timestamp(*ptr));
+#endif
+        *dst++ = '\n';
+        ptr++;
+    }
+    return dst - start;
+}
+
+#if ASCII_BENCHMARK
+// The snprintf based formatter ascii_format_frames replaced, kept for comparison
+static size_t ascii_format_frames_snprintf(char *dst, snsr_dataframe_t const *ptr, ringbuffer_size_t nframes) {
+    size_t len = 0;
     
-    if (wrcnt == 0)
-        snsr_buffer_overrun = true;
-    else if ((sensor.status = sensor_read(&sensor, ptr)) == SNSR_STATUS_OK)
-        ringbuffer_advance_write_index(&snsr_buffer, 1);
+    while (nframes--) {
+        snsr_data_t const *scalarptr = *ptr;
+        len += snprintf(dst+len, ASCII_LINE_LEN + 1, "%d", *scalarptr++);
+        for (int j=1; j < SNSR_NUM_AXES; j++) {
+            len += snprintf(dst+len, ASCII_LINE_LEN + 1, " %d", *scalarptr++);
+        }
+        #if SNSR_USE_TIMESTAMP
+        len += snprintf(dst+len, ASCII_LINE_LEN + 1, " %lu", (unsigned long) snsr_get_timestamp(*ptr));
+        #endif
+        len += snprintf(dst+len, ASCII_LINE_LEN + 1, "\n");
+        ptr++;
+    }
+    return len;
 }
 
+// Time both formatters on a batch of worst case frames and report the CPU
+// cycles each takes per frame
+static void ascii_benchmark() {
+    static snsr_dataframe_t frames[ASCII_BATCH_FRAMES];
+    static char lines[ASCII_BATCH_FRAMES * ASCII_LINE_LEN + 1];
+    uint32_t t0, fast, slow;
+    
+    for (int i=0; i < ASCII_BATCH_FRAMES; i++) {
+        for (int j=0; j < SNSR_NUM_AXES; j++) {
+            frames[i][j] = (j & 1) ? -32768 + i : 32767 - i;
+        }
+        snsr_set_timestamp(frames[i], 4000000000UL + i);
+    }
+    
+    CYCLES_Start();
+    t0 = CYCLES_Get();
+    ascii_format_frames(lines, frames, ASCII_BATCH_FRAMES);
+    fast = (t0 - CYCLES_Get()) & CYCLES_MASK;
+    t0 = CYCLES_Get();
+    ascii_format_frames_snprintf(lines, frames, ASCII_BATCH_FRAMES);
+    slow = (t0 - CYCLES_Get()) & CYCLES_MASK;
+    CYCLES_Stop();
+    
+    printf("ascii formatter takes %lu cycles per frame (snprintf %lu)\n",
+            (unsigned long) (fast / ASCII_BATCH_FRAMES), (unsigned long) (slow / ASCII_BATCH_FRAMES));
+}
+#endif //ASCII_BENCHMARK
+#endif //STREAM_FORMAT_IS(ASCII)
+
+#if !STREAM_FORMAT_IS(NONE)
+// Highest sample rate the UART can stream live at the given baud rate
+static uint32_t stream_max_sample_rate(uint32_t baud) {
+    return (uint32_t) (UART_LINK_BUDGET(baud) * SNSR_SAMPLES_PER_PACKET / STREAM_PACKET_LEN);
+}
+
+// Admit the stream if it fits the link budget at the current baud rate,
+// otherwise hold it back until the host switches to a faster rate
+static void stream_admit() {
+    uint32_t budget = (uint32_t) UART_LINK_BUDGET(uart_baud);
+
+    stream_admitted = (STREAM_BYTES_PER_SEC <= budget);
+    if (!stream_admitted) {
+        printf("ERROR: stream needs %luB/s but %lu baud carries %luB/s, switch to a faster rate\n",
+                (unsigned long) STREAM_BYTES_PER_SEC, (unsigned long) uart_baud, (unsigned long) budget);
+        tickrate = TICK_RATE_FAST;
+        return;
+    }
+#if STREAM_FORMAT_IS(SMLSS)
+    tickrate = ssi_connected() ? TICK_RATE_SLOW : 0;
+#else
+    tickrate = TICK_RATE_SLOW;
+#endif
+}
+#endif
+
 #if STREAM_FORMAT_IS(SMLSS)
 static char json_config_str[SML_MAX_CONFIG_STRLEN];
+/* Length of the configuration, and how much of it the current advert has sent */
+static size_t json_config_len = 0;
+static size_t json_config_sent = 0;
+
+#if SSI_CRC_BENCHMARK && (SSI_JSON_CONFIG_VERSION >= 3)
+// Time the CRC-16 and the XOR checksum over a packet's worth of bytes and
+// report the CPU cycles per byte of each, in hundredths
+static void ssi_crc_benchmark() {
+    static uint8_t packet[SSI_HEADER_SIZE + sizeof(snsr_datapacket_t)];
+    volatile uint16_t checksum;
+    uint32_t t0, crc16, xor8;
+    
+    for (size_t i=0; i < sizeof(packet); i++) {
+        packet[i] = (uint8_t) (i * 37U);
+    }
+    
+    CYCLES_Start();
+    t0 = CYCLES_Get();
+    checksum = crc16_update(CRC16_INIT, packet, sizeof(packet));
+    crc16 = (t0 - CYCLES_Get()) & CYCLES_MASK;
+    t0 = CYCLES_Get();
+    checksum = ssi_payload_checksum_get(packet, sizeof(packet));
+    xor8 = (t0 - CYCLES_Get()) & CYCLES_MASK;
+    CYCLES_Stop();
+    (void) checksum;
+    
+    crc16 = crc16 * 100U / sizeof(packet);
+    xor8 = xor8 * 100U / sizeof(packet);
+    printf("ssi crc16 takes %lu.%02lu cycles per byte (xor %lu.%02lu)\n",
+            (unsigned long) (crc16 / 100U), (unsigned long) (crc16 % 100U),
+            (unsigned long) (xor8 / 100U), (unsigned long) (xor8 % 100U));
+}
+#endif
+
+// Append formatted text to a string being built. Once the text no longer fits
+// nothing more is written and maxlen is returned, so callers can tell that the
+// string was truncated
+static size_t json_append(char str[], size_t maxlen, size_t written, const char *format, ...)
+{
+    va_list args;
+    int len;
+
+    if (written >= maxlen)
+        return maxlen;
+    va_start(args, format);
+    len = vsnprintf(str + written, maxlen - written, format, args);
+    va_end(args);
+    if (len < 0 || (size_t) len >= maxlen - written)
+        return maxlen;
+    return written + len;
+}
+
+#if SSI_MULTI_CHANNEL
+static const char * const ssi_accel_columns[] = { "AccelerometerX", "AccelerometerY", "AccelerometerZ" };
+static const char * const ssi_gyro_columns[] = { "GyroscopeX", "GyroscopeY", "GyroscopeZ" };
+static const char * const ssi_temp_columns[] = { "Temperature" };
+static const char * const ssi_event_columns[] = { "EventCode", "EventValue" };
+
+// Describe one channel of the stream: its rate, samples per packet and the
+// location of its columns, the timestamp words last
+static size_t ssi_build_json_channel(char json_config_str[], size_t maxlen, bool first, int channel, unsigned long sample_rate,
+        int samples_per_packet, const char * const columns[], int ncolumns, int timestamp_words)
+{
+    size_t written=0;
+    int index = 0;
+
+    /* Channels after the first in the list are separated by a comma */
+    written = json_append(json_config_str, maxlen, written,
+            "%s{\"channel\":%d"
+            ",\"sample_rate\":%lu"
+            ",\"samples_per_packet\":%d"
+            ",\"column_location\":{"
+            , first ? "" : ",", channel, sample_rate, samples_per_packet);
+    for (; index < ncolumns; index++) {
+        written = json_append(json_config_str, maxlen, written, "\"%s\":%d,", columns[index], index);
+    }
+    for (int i=0; i < timestamp_words; i++) {
+        written = json_append(json_config_str, maxlen, written, "\"Timestamp%d\":%d,", i, index++);
+    }
+    /* Drop the comma after the last column */
+    if (written < maxlen)
+        written--;
+    written = json_append(json_config_str, maxlen, written, "}}");
+
+    return written;
+}
+#endif
 
 size_t ssi_build_json_config(char json_config_str[], size_t maxlen)
 {
     size_t written=0;
     size_t snsr_index = 0;
 
-    written += snprintf(json_config_str, maxlen,
+    written = json_append(json_config_str, maxlen, written,
             "{\"version\":%d"
             ",\"sample_rate\":%d"
+            ",\"max_live_sample_rate\":%lu"
             ",\"samples_per_packet\":%d"
             ",\"column_location\":{"
-            , SSI_JSON_CONFIG_VERSION, SNSR_SAMPLE_RATE, SNSR_SAMPLES_PER_PACKET);
+            , SSI_JSON_CONFIG_VERSION, SNSR_SAMPLE_RATE, (unsigned long) stream_max_sample_rate(uart_baud), SNSR_SAMPLES_PER_PACKET);
 #if SNSR_USE_ACCEL
-    written += snprintf(json_config_str+written, maxlen-written, "\"AccelerometerX\":%d,", snsr_index++);
-    written += snprintf(json_config_str+written, maxlen-written, "\"AccelerometerY\":%d,", snsr_index++);
-    written += snprintf(json_config_str+written, maxlen-written, "\"AccelerometerZ\":%d,", snsr_index++);
+    written = json_append(json_config_str, maxlen, written, "\"AccelerometerX\":%d,", snsr_index++);
+    written = json_append(json_config_str, maxlen, written, "\"AccelerometerY\":%d,", snsr_index++);
+    written = json_append(json_config_str, maxlen, written, "\"AccelerometerZ\":%d,", snsr_index++);
 #endif
-#if SNSR_USE_GYRO
-    written += snprintf(json_config_str+written, maxlen-written, "\"GyroscopeX\":%d,", snsr_index++);
-    written += snprintf(json_config_str+written, maxlen-written, "\"GyroscopeY\":%d,", snsr_index++);
-    written += snprintf(json_config_str+written, maxlen-written, "\"GyroscopeZ\":%d", snsr_index++);
+#if SNSR_USE_GYRO && !SSI_MULTI_CHANNEL
+    /* With several channels the top level describes channel 0 alone */
+    written = json_append(json_config_str, maxlen, written, "\"GyroscopeX\":%d,", snsr_index++);
+    written = json_append(json_config_str, maxlen, written, "\"GyroscopeY\":%d,", snsr_index++);
+    written = json_append(json_config_str, maxlen, written, "\"GyroscopeZ\":%d,", snsr_index++);
+#endif
+#if SNSR_USE_TIMESTAMP
+    /* Microsecond timestamp split into little endian words */
+    for (int i=0; i < SNSR_TIMESTAMP_WORDS; i++) {
+        written = json_append(json_config_str, maxlen, written, "\"Timestamp%d\":%d,", i, snsr_index++);
+    }
 #endif
-    if(json_config_str[written-1] == ',')
+    if((written < maxlen) && (json_config_str[written-1] == ','))
     {
         written--;
     }
-    snprintf(json_config_str+written, maxlen-written, "}}\n");
+    written = json_append(json_config_str, maxlen, written, "}");
+#if SSI_MULTI_CHANNEL
+    written = json_append(json_config_str, maxlen, written, ",\"channels\":[");
+#if SNSR_USE_ACCEL
+    written += ssi_build_json_channel(json_config_str+written, maxlen-written, true, SSI_CHANNEL_ACCEL, SNSR_SAMPLE_RATE,
+            SNSR_SAMPLES_PER_PACKET, ssi_accel_columns, 3, SNSR_TIMESTAMP_WORDS);
+#endif
+#if SNSR_USE_GYRO
+    written += ssi_build_json_channel(json_config_str+written, maxlen-written, !SNSR_USE_ACCEL, SSI_CHANNEL_GYRO, SNSR_SAMPLE_RATE / SSI_GYRO_DECIMATION,
+            SSI_GYRO_SAMPLES_PER_PACKET, ssi_gyro_columns, 3, SNSR_TIMESTAMP_WORDS);
+#endif
+    written += ssi_build_json_channel(json_config_str+written, maxlen-written, !SNSR_USE_ACCEL && !SNSR_USE_GYRO, SSI_CHANNEL_TEMP, SSI_TEMP_RATE,
+            1, ssi_temp_columns, 1, SNSR_TIMESTAMP_WORDS);
+    written += ssi_build_json_channel(json_config_str+written, maxlen-written, false, SSI_CHANNEL_EVENT, 0,
+            1, ssi_event_columns, 2, SSI_EVENT_TIMESTAMP_WORDS);
+    written = json_append(json_config_str, maxlen, written, "]");
+#endif
+    written = json_append(json_config_str, maxlen, written, "}\n");
 
     return written;
 }
 
+// Build the JSON configuration for adverts, dropping any advert part sent;
+// returns false if it does not fit in json_config_str
+static bool ssi_config_update() {
+    json_config_len = ssi_build_json_config(json_config_str, SML_MAX_CONFIG_STRLEN);
+    if (json_config_len >= SML_MAX_CONFIG_STRLEN)
+        json_config_len = 0;
+    json_config_sent = json_config_len;
+    return json_config_len != 0;
+}
+
+// Send what the transmit queue has room for of the advert in progress; with
+// several channels the configuration is longer than the queue
+static void ssi_config_advertise_task() {
+    size_t len = json_config_len - json_config_sent;
+    size_t space = UART_TxFreeGet();
+
+    if (len > space)
+        len = space;
+    if (len && UART_Write((uint8_t *) json_config_str + json_config_sent, len))
+        json_config_sent += len;
+}
+
+#if SSI_MULTI_CHANNEL
+// Share the buffered sample frames out to the accelerometer and gyroscope
+// channels, publishing each packet as it fills. Packets are copied out, so
+// frames are released as soon as they are taken; while a full packet waits for
+// room in the transmit queue no more frames are taken
+static void ssi_channels_task() {
+    snsr_dataframe_t const *ptr;
+    
+    while (true) {
+        for (size_t i=0; i < SSI_IMU_CHANNELS; i++) {
+            ssi_imu_channel_t *ch = &ssi_imu_channels[i];
+            if (ch->count < ch->samples_per_packet)
+                continue;
+            if (ssiv2_publish_sensor_data_copy(ch->channel, (uint8_t const *) ch->packet, ch->count * sizeof(ch->packet[0])) == 0)
+                return;
+            ch->count = 0;
+            
+            /* Don't let a long backlog of packets starve the sensor */
+            snsr_read_task();
+        }
+        
+        if ((ptr = snsr_ringbuffer_peek(&snsr_buffer, 0)) == NULL)
+            return;
+        
+        for (size_t i=0; i < SSI_IMU_CHANNELS; i++) {
+            ssi_imu_channel_t *ch = &ssi_imu_channels[i];
+#if SNSR_USE_TIMESTAMP
+            if (ch->phase == 0)
+                memcpy(&ch->packet[ch->count][3], &(*ptr)[SNSR_NUM_AXES], SNSR_TIMESTAMP_WORDS * sizeof(snsr_data_t));
+#endif
+            for (int axis=0; axis < 3; axis++)
+                ch->sum[axis] += (*ptr)[ch->offset + axis];
+            if (++ch->phase < ch->decimation)
+                continue;
+            for (int axis=0; axis < 3; axis++) {
+                ch->packet[ch->count][axis] = (snsr_data_t) (ch->sum[axis] / ch->decimation);
+                ch->sum[axis] = 0;
+            }
+            ch->phase = 0;
+            ch->count++;
+        }
+        snsr_ringbuffer_advance_read_index(&snsr_buffer, 1);
+#if SNSR_OVERRUN_CONTINUOUS
+        stream_frames_out++;
+#endif
+    }
+}
+
+// Publish the die temperature every 1/SSI_TEMP_RATE seconds. The register read
+// waits for the bus, so it is left for a pass with no sample read in flight
+// and room in the transmit queue
+static void ssi_temp_task() {
+    snsr_data_t packet[SSI_TEMP_COLUMNS];
+    int16_t centidegrees;
+    
+    if (read_timer_ms() < ssi_temp_due_ms || snsr_read_busy
+            || UART_TxFreeGet() < SSI_HEADER_SIZE + sizeof(packet) + SSI_CHECKSUM_SIZE)
+        return;
+    ssi_temp_due_ms = read_timer_ms() + 1000U / SSI_TEMP_RATE;
+    
+    if (sensor_read_temperature(&sensor, &centidegrees) != SNSR_STATUS_OK)
+        return;
+    packet[0] = (snsr_data_t) centidegrees;
+#if SNSR_USE_TIMESTAMP
+    uint32_t timestamp_us = (uint32_t) read_timer_us();
+    memcpy(&packet[1], &timestamp_us, sizeof(timestamp_us));
+#endif
+    ssiv2_publish_sensor_data_copy(SSI_CHANNEL_TEMP, (uint8_t const *) packet, sizeof(packet));
+}
+
+#endif //SSI_MULTI_CHANNEL
+
+#if (SSI_JSON_CONFIG_VERSION >= 2)
+// Publish an event of the given time; returns false if the transmit queue is full
+static bool ssi_event_publish(snsr_data_t code, snsr_data_t value, uint32_t timestamp_us) {
+    snsr_data_t packet[SSI_EVENT_COLUMNS] = { code, value };
+    
+    memcpy(&packet[2], &timestamp_us, sizeof(timestamp_us));
+    return ssiv2_publish_sensor_data_copy(SSI_CHANNEL_EVENT, (uint8_t const *) packet, sizeof(packet)) != 0;
+}
+#endif
+
 #endif //STREAM_FORMAT_IS(SMLSS)
 
+#if SNSR_OVERRUN_CONTINUOUS && !STREAM_FORMAT_IS(NONE)
+// Frames the streamer may take before it reaches the next queued gap
+static uint32_t stream_gap_ahead() {
+    const snsr_gap_t *gap = snsr_gap_ringbuffer_peek(&snsr_gaps, 0);
+    int32_t ahead;
+    
+    if (gap == NULL)
+        return UINT32_MAX;
+    ahead = (int32_t) (gap->index - stream_frames_out);
+    return (ahead > 0) ? (uint32_t) ahead : 0;
+}
+
+// Send the record of a gap in the stream format; returns false if the
+// transmit queue is full, leaving in gap what is still to be reported
+static bool stream_gap_emit(snsr_gap_t *gap) {
+    /* Frames of the next packet that come before the gap */
+    int32_t position = (int32_t) (gap->index - stream_frames_out);
+    if (position < 0)
+        position = 0;
+    
+    #if STREAM_FORMAT_IS(ASCII)
+    /* Batches stop at gaps, so the line goes exactly where the samples are missing */
+    char line[16];
+    if (UART_Write((uint8_t *) line, snprintf(line, sizeof(line), "gap %lu\n", (unsigned long) gap->lost)) == 0)
+        return false;
+    #elif STREAM_FORMAT_IS(MDV) && MDV_USE_FRAME_COUNTER
+    /* MPLAB DV frames have a fixed layout, so the gap shows as a jump in the
+     * frame count, in whole frames */
+    stream_frame_counter += (gap->lost + SNSR_SAMPLES_PER_PACKET - 1) / SNSR_SAMPLES_PER_PACKET;
+    #elif STREAM_FORMAT_IS(SMLSS) && (SSI_JSON_CONFIG_VERSION >= 2)
+    /* An event placed by the time of the gap, on a channel of its own; event
+     * values are 16 bit so a long gap takes several */
+    while (gap->lost) {
+        uint32_t value = (gap->lost > INT16_MAX) ? INT16_MAX : gap->lost;
+        if (!ssi_event_publish(SSI_EVENT_GAP, (snsr_data_t) value, gap->time_us))
+            return false;
+        gap->lost -= value;
+    }
+    #elif STREAM_FORMAT_IS(COMPRESSED)
+    uint8_t record[DELTACODEC_GAP_LEN];
+    if (UART_Write(record, deltacodec_encode_gap(gap->lost, (uint8_t) position, record)) == 0)
+        return false;
+    #elif STREAM_FORMAT_IS(COBS)
+    /* Samples lost and position; the odd length tells it from a data frame */
+    uint8_t record[5] = { (uint8_t) gap->lost, (uint8_t) (gap->lost >> 8), (uint8_t) (gap->lost >> 16),
+                          (uint8_t) (gap->lost >> 24), (uint8_t) position };
+    uint16_t crc = crc16_update(CRC16_INIT, record, sizeof(record));
+    uint8_t check[2] = { (uint8_t) crc, (uint8_t) (crc >> 8) };
+    uint8_t frame[COBS_ENCODED_MAXLEN(sizeof(record) + sizeof(check))];
+    cobs_encoder_t encoder;
+    cobs_encode_begin(&encoder, frame);
+    cobs_encode_put(&encoder, record, sizeof(record));
+    cobs_encode_put(&encoder, check, sizeof(check));
+    if (UART_Write(frame, cobs_encode_end(&encoder)) == 0)
+        return false;
+    #endif
+    (void) position;
+    
+    gap->lost = 0;
+    return true;
+}
+
+// Report the gaps that open before frame nframes of the next packet, ahead of
+// it; returns false while a report waits for room in the transmit queue
+static bool stream_gap_task(ringbuffer_size_t nframes) {
+    while (stream_gap.lost || stream_gap_ahead() < nframes) {
+        if (stream_gap.lost == 0)
+            snsr_gap_ringbuffer_read(&snsr_gaps, &stream_gap, 1);
+        if (!stream_gap_emit(&stream_gap))
+            return false;
+    }
+    return true;
+}
+#endif
+
+static void uart_rx_flush() {
+    uart_rx_ringbuffer_advance_read_index(&uartRxBuffer, uart_rx_ringbuffer_get_read_items(&uartRxBuffer));
+}
+
+// Look for a host command at the head of the UART RX buffer. Returns the
+// number of characters buffered so far if they can be one, 0 if they can't.
+// Once the newline has arrived the line is consumed into cmd, and complete set
+static size_t host_cmd_get(char cmd[HOST_CMD_MAXLEN + 1], bool *complete) {
+    ringbuffer_size_t avail = uart_rx_ringbuffer_get_read_items(&uartRxBuffer);
+    bool baud = true, status = RINGBUFFER_STATS;
+    size_t i;
+
+    *complete = false;
+    for (i = 0; i < avail && i < HOST_CMD_MAXLEN; i++) {
+        char c = (char) *uart_rx_ringbuffer_peek(&uartRxBuffer, i);
+        baud = baud && (i >= BAUD_CMD_CHARS || c == BAUD_CMD[i]);
+        status = status && ((i < STATUS_CMD_CHARS) ? (c == STATUS_CMD[i]) : (c == '\r' || c == '\n'));
+        if (!baud && !status)
+            return 0;
+        if (c == '\n') {
+            cmd[i] = '\0';
+            uart_rx_ringbuffer_advance_read_index(&uartRxBuffer, i + 1);
+            *complete = true;
+            return i + 1;
+        }
+        cmd[i] = c;
+    }
+    
+    /* Too long for a valid command */
+    return (i < HOST_CMD_MAXLEN) ? i : 0;
+}
+
+// Parse the rate of a complete baud command; returns 0 if it is malformed
+static uint32_t baud_cmd_rate(const char *cmd) {
+    char *end;
+    unsigned long baud = strtoul(cmd + BAUD_CMD_CHARS, &end, 10);
+
+    if (end == cmd + BAUD_CMD_CHARS || (*end != '\0' && *end != '\r'))
+        return 0;
+    return (uint32_t) baud;
+}
+
+static bool baud_reply(uint32_t baud, const char *status) {
+    char reply[HOST_CMD_MAXLEN + 8];
+    int len = snprintf(reply, sizeof(reply), BAUD_CMD "%lu %s\n", (unsigned long) baud, status);
+    return UART_Write((uint8_t *) reply, len) != 0;
+}
+
+// Runtime baud rate negotiation, serviced from the main loop; while idle it
+// also takes in the status command for status_task:
+//   host -> "baud <rate>\n"         at the current rate
+//   dev  -> "baud <rate> ack\n"     at the current rate (or "nak"), then switches
+//   host -> "baud <rate>\n"         at the new rate within UART_BAUD_CONFIRM_MS
+//   dev  -> "baud <rate> ok\n"      at the new rate
+// Without the confirmation the device falls back to the previous rate.
+// uart_rx_held is set while other readers must leave the RX buffer alone
+static void baud_task() {
+    char cmd[HOST_CMD_MAXLEN + 1];
+    bool complete;
+    size_t len;
+    uint32_t baud;
+
+    switch (baud_state) {
+    case BAUD_STATE_DRAIN:
+        /* Switch once the ack has left the shift register */
+        if (UART_TxIsBusy() || !UART_TxIsComplete())
+            break;
+        if (!UART_BaudSet(baud_requested)) {
+            baud_state = BAUD_STATE_IDLE;
+            break;
+        }
+        uart_rx_flush();
+        baud_deadline_ms = read_timer_ms() + UART_BAUD_CONFIRM_MS;
+        baud_state = BAUD_STATE_CONFIRM;
+        break;
+
+    case BAUD_STATE_CONFIRM:
+        len = host_cmd_get(cmd, &complete);
+        if (complete && baud_cmd_rate(cmd) == baud_requested) {
+            uart_baud = baud_requested;
+            baud_state = BAUD_STATE_IDLE;
+            baud_reply(uart_baud, "ok");
+#if !STREAM_FORMAT_IS(NONE)
+            stream_admit();
+#endif
+#if STREAM_FORMAT_IS(SMLSS)
+            /* Advertise the new link budget */
+            ssi_config_update();
+    #if SSI_MULTI_CHANNEL
+            if (ssi_connected())
+                ssi_event_publish(SSI_EVENT_BAUD, (snsr_data_t) (uart_baud / 100U), (uint32_t) read_timer_us());
+    #endif
+#endif
+        }
+        else if (read_timer_ms() >= baud_deadline_ms) {
+            /* No valid traffic at the new rate */
+            UART_BaudSet(uart_baud);
+            uart_rx_flush();
+            baud_state = BAUD_STATE_IDLE;
+        }
+        else if (len == 0) {
+            uart_rx_flush();
+        }
+        break;
+
+    default:
+        len = host_cmd_get(cmd, &complete);
+#if RINGBUFFER_STATS
+        if (complete && cmd[0] == STATUS_CMD[0]) {
+            /* Answered by status_task */
+            status_requested = true;
+        }
+        else
+#endif
+        if (complete) {
+            baud = baud_cmd_rate(cmd);
+            if (baud < UART_BAUD_MIN || baud > UART_BAUD_MAX)
+                baud_reply(baud, "nak");
+            else if (baud_reply(baud, "ack")) {
+                baud_requested = baud;
+                baud_state = BAUD_STATE_DRAIN;
+            }
+        }
+#if !STREAM_FORMAT_IS(SMLSS)
+        /* Nothing else reads the RX buffer */
+        else if (len == 0) {
+            uart_rx_flush();
+        }
+#endif
+        uart_rx_held = (len > 0 && !complete);
+        return;
+    }
+    uart_rx_held = true;
+}
+
+#if RINGBUFFER_STATS
+/* Longest status line: "status <name>", five counts of up to 17 characters,
+ * last_full, the histogram and the newline */
+#define STATUS_LINE_MAXLEN  (14 + 5 * 17 + 23 + 6 + RINGBUFFER_STATS_BINS * 11 + 1)
+
+// Describe a buffer as a line of the status reply, returning its length
+static size_t status_format(char dst[STATUS_LINE_MAXLEN + 1], const char *name, ringbuffer_size_t len,
+        ringbuffer_size_t fill, const ringbuffer_stats_t *stats) {
+    size_t n = snprintf(dst, STATUS_LINE_MAXLEN, STATUS_CMD " %s len=%lu fill=%lu high=%lu over=%lu full=%lu",
+            name, (unsigned long) len, (unsigned long) fill, (unsigned long) stats->high_water,
+            (unsigned long) stats->overruns, (unsigned long) stats->fulls);
+    
+    if (stats->fulls)
+        n += snprintf(dst + n, STATUS_LINE_MAXLEN - n, " last_full=%lums",
+                (unsigned long) ((uint64_t) (stats_clock() - stats->last_full) * 1024U / 1000U));
+    n += snprintf(dst + n, STATUS_LINE_MAXLEN - n, " hist=");
+    for (int i = 0; i < RINGBUFFER_STATS_BINS; i++)
+        n += snprintf(dst + n, STATUS_LINE_MAXLEN - n, (i == 0) ? "%lu" : ",%lu", (unsigned long) stats->histogram[i]);
+    dst[n++] = '\n';
+    
+    return n;
+}
+
+// Answer the status command with the occupancy telemetry of the sample and
+// UART RX buffers, one line each:
+//   dev  -> "status <buffer> len=<items> fill=<items now> high=<most items held>
+//            over=<items dropped for want of room> under=<items released that
+//            were not there> full=<times filled> [last_full=<ms since>]
+//            hist=<writes leaving the buffer up to 1/8 full>,...,<up to 8/8 full>\n"
+// The reply goes out between stream packets, like the baud replies
+static void status_task() {
+    char reply[2 * STATUS_LINE_MAXLEN + 1];
+    size_t len;
+
+    if (!status_requested || baud_state != BAUD_STATE_IDLE)
+        return;
+    
+    len = status_format(reply, "snsr", SNSR_BUF_LEN, snsr_ringbuffer_get_read_items(&snsr_buffer), &snsr_buffer_stats);
+    len += status_format(reply + len, "uart_rx", UART_RXBUF_LEN, uart_rx_ringbuffer_get_read_items(&uartRxBuffer), &uart_rx_stats);
+    
+    /* Try again on the next pass if the transmit queue is too full */
+    if (UART_Write((uint8_t *) reply, len))
+        status_requested = false;
+}
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Main Entry Point
@@ -188,8 +1195,8 @@ int main ( void )
     /* Initialize all modules */
     SYS_Initialize ( NULL );
 
-    /* Register and start the millisecond interrupt ticker */
-    TC_TimerCallbackRegister(Ticker_Callback);
+    /* Register the overflow extension and start the microsecond clock */
+    TC_TimerCallbackRegister(Timer_Overflow_Callback);
     TC_TimerStart();
 
     printf("\n");
@@ -199,12 +1206,16 @@ int main ( void )
     while (1)
     {
         /* Initialize the sensor data buffer */
-        if (ringbuffer_init(&snsr_buffer, _snsr_buffer_data, sizeof(_snsr_buffer_data) / sizeof(_snsr_buffer_data[0]), sizeof(_snsr_buffer_data[0])))
-            break;
+        snsr_ringbuffer_reset(&snsr_buffer);
     
         /* Initialize the UART RX buffer */
-        if (ringbuffer_init(&uartRxBuffer, _uartRxBuffer_data, sizeof(_uartRxBuffer_data) / sizeof(_uartRxBuffer_data[0]), sizeof(_uartRxBuffer_data[0])))
-            break;
+        uart_rx_ringbuffer_reset(&uartRxBuffer);
+
+#if RINGBUFFER_STATS
+        /* Keep track of how full the buffers run */
+        snsr_ringbuffer_attach_stats(&snsr_buffer, &snsr_buffer_stats, stats_clock);
+        uart_rx_ringbuffer_attach_stats(&uartRxBuffer, &uart_rx_stats, stats_clock);
+#endif
 
         /* Enable the RX interrupt */
         UART_RXC_Enable();
@@ -221,7 +1232,25 @@ int main ( void )
         }
 
         printf("sensor type is %s\n", SNSR_NAME);
+#if !STREAM_FORMAT_IS(NONE)
+        printf("UART at %lu baud streams live up to %luHz\n", (unsigned long) uart_baud, (unsigned long) stream_max_sample_rate(uart_baud));
+#endif
         printf("sensor sample rate set at %dHz\n", SNSR_SAMPLE_RATE);
+#if SNSR_USE_FIFO
+        printf("sensor FIFO enabled with watermark set at %d samples\n", SNSR_FIFO_WATERMARK);
+#endif
+#if SNSR_USE_CLKIN
+        printf("sensor clock locked to the MCU via CLKIN\n");
+#endif
+#if SNSR_USE_TIMESTAMP
+        printf("sample timestamps enabled in microseconds\n");
+#endif
+#if STREAM_FORMAT_IS(ASCII) && ASCII_BENCHMARK
+        ascii_benchmark();
+#endif
+#if STREAM_FORMAT_IS(SMLSS) && SSI_CRC_BENCHMARK && (SSI_JSON_CONFIG_VERSION >= 3)
+        ssi_crc_benchmark();
+#endif
 #if SNSR_USE_ACCEL
         printf("accelerometer enabled with range set at +/-%dGs\n", SNSR_ACCEL_RANGE);
 #else
@@ -237,9 +1266,17 @@ int main ( void )
         /* Init SensiML simple-stream interface */
         ssi_io_s.ssi_read = UART_Read;
         ssi_io_s.ssi_write = UART_Write;
+        ssi_io_s.ssi_writev = UART_WriteV;
         ssi_io_s.connected = false;
         ssi_init(&ssi_io_s);
-        ssi_build_json_config(json_config_str, SML_MAX_CONFIG_STRLEN);
+        if (!ssi_config_update()) {
+            printf("ERROR: JSON configuration longer than SML_MAX_CONFIG_STRLEN\n");
+            break;
+        }
+#elif STREAM_FORMAT_IS(COMPRESSED)
+        /* Init the packet encoder */
+        if (deltacodec_init(&compressed_codec, compressed_prev, SNSR_NUM_COLUMNS, COMPRESSED_KEYFRAME_INTERVAL))
+            break;
 #endif
 
         /* Activate External Interrupt Controller for sensor capture */
@@ -257,6 +1294,11 @@ int main ( void )
         tickrate = TICK_RATE_SLOW;
 #endif //STREAM_FORMAT_IS(SMLSS)
 
+#if !STREAM_FORMAT_IS(NONE)
+        /* STATE CHANGE - Application is waiting for a faster link if the stream doesn't fit */
+        stream_admit();
+#endif
+
         app_failed = 0;
         break;
     }
@@ -266,30 +1308,71 @@ int main ( void )
         /* Maintain state machines of all system modules. */
         SYS_Tasks ( );
 
+        /* Update the status LED */
+        Ticker_Task();
+
+        /* Service any pending sensor read */
+        snsr_read_task();
+
+        /* Reclaim buffer space from packets that have been sent */
+        snsr_tx_release();
+
+        /* Handle baud rate requests from the host */
+        baud_task();
+#if RINGBUFFER_STATS
+        status_task();
+#endif
+
         if (sensor.status != SNSR_STATUS_OK) {
             printf("ERROR: Got a bad sensor status: %d\n", sensor.status);
             break;
         }
+        else if (baud_state == BAUD_STATE_DRAIN) {
+            /* Hold off output until the link has switched rate */
+        }
 #if STREAM_FORMAT_IS(SMLSS)
         else if (!ssi_connected()) {
-            if (ringbuffer_get_read_items(&uartRxBuffer) >= CONNECT_CHARS) {
+            if (!uart_rx_held && uart_rx_ringbuffer_get_read_items(&uartRxBuffer) >= CONNECT_CHARS) {
                 ssi_try_connect();
-                ringbuffer_advance_read_index(&uartRxBuffer, ringbuffer_get_read_items(&uartRxBuffer));
+                uart_rx_ringbuffer_advance_read_index(&uartRxBuffer, uart_rx_ringbuffer_get_read_items(&uartRxBuffer));
             }
             if (ssi_connected()) {
                 /* STATE CHANGE - Application is streaming */
                 tickrate = TICK_RATE_SLOW;
 
                 /* Reset the sensor buffer */
-                MIKRO_INT_CallbackRegister(Null_Handler);
-                ringbuffer_reset(&snsr_buffer);
-                snsr_buffer_overrun = false;
-                MIKRO_INT_CallbackRegister(SNSR_ISR_HANDLER);
+                snsr_buffer_reset();
+
+                /* Drop the rest of any advert */
+                json_config_sent = json_config_len;
             }
-            if (read_timer_ms() - ssi_adtimer > 500) {
+            else if (json_config_sent == json_config_len && read_timer_ms() - ssi_adtimer > 500) {
                 ssi_adtimer = read_timer_ms();
-                UART_Write((uint8_t *) json_config_str, strlen(json_config_str));
+                json_config_sent = 0;
             }
+            ssi_config_advertise_task();
+        }
+#endif
+#if !STREAM_FORMAT_IS(NONE)
+        else if (!stream_admitted) {
+            /* Drop samples rather than overrun until the link is fast enough */
+            tickrate = TICK_RATE_FAST;
+            if (snsr_tx_inflight == 0) {
+                ringbuffer_size_t dropped = snsr_ringbuffer_advance_read_index(&snsr_buffer, snsr_ringbuffer_get_read_items(&snsr_buffer));
+    #if SNSR_OVERRUN_CONTINUOUS
+                stream_frames_out += dropped;
+    #endif
+    #if STREAM_USE_FRAME_COUNTER
+                if (dropped)
+                    stream_frame_counter++;
+    #endif
+                (void) dropped;
+            }
+    #if STREAM_FORMAT_IS(COMPRESSED)
+            deltacodec_reset(&compressed_codec);
+    #elif STREAM_FORMAT_IS(SMLSS) && SSI_MULTI_CHANNEL
+            ssi_channels_reset();
+    #endif
         }
 #endif
         else if (snsr_buffer_overrun == true) {
@@ -302,62 +1385,150 @@ int main ( void )
             sleep_ms(5000U);
 
             // Clear OVERFLOW
-            MIKRO_INT_CallbackRegister(Null_Handler);
-            ringbuffer_reset(&snsr_buffer);
-            snsr_buffer_overrun = false;
-            MIKRO_INT_CallbackRegister(SNSR_ISR_HANDLER);
+            snsr_buffer_reset();
+#if STREAM_FORMAT_IS(SMLSS) && SSI_MULTI_CHANNEL
+            ssi_event_publish(SSI_EVENT_OVERRUN, 0, (uint32_t) read_timer_us());
+#endif
 
             /* STATE CHANGE - Application is streaming */
             tickrate = TICK_RATE_SLOW;
             LED_ALL_Off();
             continue;
         }
-#if !STREAM_FORMAT_IS(NONE)
-        else if(ringbuffer_get_read_items(&snsr_buffer) >= SNSR_SAMPLES_PER_PACKET) {
-            ringbuffer_size_t rdcnt;
-            snsr_dataframe_t const *ptr = ringbuffer_get_read_buffer(&snsr_buffer, &rdcnt);
-            while (rdcnt >= SNSR_SAMPLES_PER_PACKET) {
-    #if STREAM_FORMAT_IS(ASCII)
-                snsr_data_t const *scalarptr = (snsr_data_t const *) ptr;
-                printf("%d", *scalarptr++);
-                for (int j=1; j < sizeof(snsr_datapacket_t) / sizeof(snsr_data_t); j++) {
-                    printf(" %d", *scalarptr++);
+#if STREAM_FORMAT_IS(SMLSS) && SSI_MULTI_CHANNEL
+        else {
+            /* Each channel is packed and published at its own rate */
+            ssi_channels_task();
+            ssi_temp_task();
+    #if SNSR_OVERRUN_CONTINUOUS
+            /* Gap events carry their time, so they need not interrupt the channels */
+            stream_gap_task(1);
+    #endif
+        }
+#elif !STREAM_FORMAT_IS(NONE)
+        else if(snsr_ringbuffer_get_read_items(&snsr_buffer) - snsr_tx_inflight >= SNSR_SAMPLES_PER_PACKET) {
+            snsr_ringbuffer_read_spans_t spans;
+            
+            /* A packet that wraps around the end of the buffer comes in two spans;
+             * one that doesn't fit in the transmit queue stays buffered for the next pass */
+            while (snsr_ringbuffer_peek_read_spans(&snsr_buffer, snsr_tx_inflight, SNSR_SAMPLES_PER_PACKET, &spans) == SNSR_SAMPLES_PER_PACKET) {
+                ringbuffer_size_t nframes = SNSR_SAMPLES_PER_PACKET;
+                size_t len0 = spans.itemcount[0] * sizeof(snsr_dataframe_t);
+                size_t len1 = spans.itemcount[1] * sizeof(snsr_dataframe_t);
+    #if SNSR_OVERRUN_CONTINUOUS
+                /* Samples lost ahead of the packet are reported first */
+                if (!stream_gap_task(nframes))
+                    break;
+    #endif
+    #if STREAM_FORMAT_IS(ASCII) || STREAM_FORMAT_IS(COMPRESSED) || STREAM_FORMAT_IS(COBS)
+        #if STREAM_FORMAT_IS(ASCII)
+                /* Render as many lines as the transmit queue has room for in one go */
+                char lines[ASCII_BATCH_FRAMES * ASCII_LINE_LEN];
+                size_t space = UART_TxFreeGet() / ASCII_LINE_LEN;
+                if (space == 0)
+                    break;
+                if (space > ASCII_BATCH_FRAMES)
+                    space = ASCII_BATCH_FRAMES;
+            #if SNSR_OVERRUN_CONTINUOUS
+                if (space > stream_gap_ahead())
+                    space = stream_gap_ahead();
+            #endif
+                nframes = snsr_ringbuffer_get_read_spans(&snsr_buffer, space, &spans);
+                len0 = ascii_format_frames(lines, spans.data[0], spans.itemcount[0]);
+                len1 = ascii_format_frames(lines + len0, spans.data[1], spans.itemcount[1]);
+                if (UART_Write((uint8_t *) lines, len0 + len1) == 0)
+                    break;
+        #elif STREAM_FORMAT_IS(COMPRESSED)
+                /* The encoder takes the frames in one piece, so join a wrapped packet */
+                snsr_datapacket_t joined;
+                snsr_data_t const *frames = *spans.data[0];
+                if (len1) {
+                    memcpy(joined, spans.data[0], len0);
+                    memcpy((uint8_t *) joined + len0, spans.data[1], len1);
+                    frames = joined;
                 }
-                printf("\n");
-    #elif STREAM_FORMAT_IS(MDV)
-                uint8_t headerbyte = MDV_START_OF_FRAME;
-                UART_Write(&headerbyte, 1);
-                UART_Write((uint8_t *) ptr, sizeof(snsr_datapacket_t));
-                headerbyte = ~headerbyte;
-                UART_Write(&headerbyte, 1);
-    #elif STREAM_FORMAT_IS(SMLSS)
-                #if (SSI_JSON_CONFIG_VERSION == 2)
-                ssiv2_publish_sensor_data(0, (uint8_t*) ptr, sizeof(snsr_datapacket_t));
-                #elif (SSI_JSON_CONFIG_VERSION == 1)
-                ssiv1_publish_sensor_data((uint8_t*) ptr, sizeof(snsr_datapacket_t));
-                #endif
-    #endif //STREAM_FORMAT_IS(ASCII)
-                ptr += SNSR_SAMPLES_PER_PACKET;
-                rdcnt -= SNSR_SAMPLES_PER_PACKET;
-                ringbuffer_advance_read_index(&snsr_buffer, SNSR_SAMPLES_PER_PACKET);
+                uint8_t packet[COMPRESSED_PACKET_MAXLEN];
+                size_t len = deltacodec_encode(&compressed_codec, frames, SNSR_SAMPLES_PER_PACKET, packet);
+                if (UART_Write(packet, len) == 0)
+                    break;
+                deltacodec_commit(&compressed_codec, frames, SNSR_SAMPLES_PER_PACKET);
+        #elif STREAM_FORMAT_IS(COBS)
+                /* Stuffing rewrites the samples, so the frame is built in a copy */
+                uint8_t frame[STREAM_PACKET_LEN];
+                uint8_t counter[2] = { (uint8_t) stream_frame_counter, (uint8_t) (stream_frame_counter >> 8) };
+                uint16_t crc = crc16_update(CRC16_INIT, counter, sizeof(counter));
+                crc = crc16_update(crc, (const uint8_t *) spans.data[0], len0);
+                crc = crc16_update(crc, (const uint8_t *) spans.data[1], len1);
+                uint8_t check[2] = { (uint8_t) crc, (uint8_t) (crc >> 8) };
+                cobs_encoder_t encoder;
+                cobs_encode_begin(&encoder, frame);
+                cobs_encode_put(&encoder, counter, sizeof(counter));
+                cobs_encode_put(&encoder, spans.data[0], len0);
+                cobs_encode_put(&encoder, spans.data[1], len1);
+                cobs_encode_put(&encoder, check, sizeof(check));
+                if (UART_Write(frame, cobs_encode_end(&encoder)) == 0)
+                    break;
+                stream_frame_counter++;
+        #endif
+                
+                /* The packet was copied out so the samples can go */
+                snsr_ringbuffer_advance_read_index(&snsr_buffer, nframes);
+    #else
+                /* The samples are sent straight from the buffer and released by snsr_tx_release */
+        #if STREAM_FORMAT_IS(MDV)
+                uint8_t trailerbyte = (uint8_t) ~MDV_START_OF_FRAME;
+            #if MDV_USE_FRAME_COUNTER
+                uint8_t header[3] = { MDV_START_OF_FRAME, (uint8_t) stream_frame_counter, (uint8_t) (stream_frame_counter >> 8) };
+            #else
+                uint8_t header[1] = { MDV_START_OF_FRAME };
+            #endif
+                uart_iovec_t iov[4] = {
+                    { header, sizeof(header), true },
+                    { (const uint8_t *) spans.data[0], len0, false },
+                    { (const uint8_t *) spans.data[1], len1, false },
+                    { &trailerbyte, 1, true }
+                };
+                int iovcnt = 4;
+                if (len1 == 0) {
+                    iov[2] = iov[3];
+                    iovcnt = 3;
+                }
+                if (UART_WriteV(iov, iovcnt) == 0)
+                    break;
+            #if MDV_USE_FRAME_COUNTER
+                stream_frame_counter++;
+            #endif
+        #elif (SSI_JSON_CONFIG_VERSION >= 2)
+                if (ssiv2_publish_sensor_data_split(0, (uint8_t*) spans.data[0], len0, (uint8_t*) spans.data[1], len1) == 0)
+                    break;
+        #elif (SSI_JSON_CONFIG_VERSION == 1)
+                if (ssiv1_publish_sensor_data_split((uint8_t*) spans.data[0], len0, (uint8_t*) spans.data[1], len1) == 0)
+                    break;
+        #endif
+                snsr_tx_inflight += SNSR_SAMPLES_PER_PACKET;
+    #endif //STREAM_FORMAT_IS(ASCII) || STREAM_FORMAT_IS(COMPRESSED) || STREAM_FORMAT_IS(COBS)
+    #if SNSR_OVERRUN_CONTINUOUS
+                stream_frames_out += nframes;
+    #endif
+
+                /* Don't let a long backlog of packets starve the sensor */
+                snsr_read_task();
             }
         }
 #else   /* Template code for processing sensor data */
         else {
-            ringbuffer_size_t rdcnt;
-            snsr_dataframe_t const *ptr = ringbuffer_get_read_buffer(&snsr_buffer, &rdcnt);
-            while (rdcnt--) {
+            snsr_dataframe_t const *ptr;
+            while ((ptr = snsr_ringbuffer_peek(&snsr_buffer, 0)) != NULL) {
                 // process sensor data
-                ptr++;
-                ringbuffer_advance_read_index(&snsr_buffer, 1);
+                snsr_ringbuffer_advance_read_index(&snsr_buffer, 1);
             }
         }
 #endif //!STREAM_FORMAT_IS(NONE)
 
 #if STREAM_FORMAT_IS(SMLSS)
-        if (ssi_connected() && ringbuffer_get_read_items(&uartRxBuffer) >= DISCONNECT_CHARS) {
+        if (ssi_connected() && !uart_rx_held && uart_rx_ringbuffer_get_read_items(&uartRxBuffer) >= DISCONNECT_CHARS) {
             ssi_try_disconnect();
-            ringbuffer_advance_read_index(&uartRxBuffer, ringbuffer_get_read_items(&uartRxBuffer));
+            uart_rx_ringbuffer_advance_read_index(&uartRxBuffer, uart_rx_ringbuffer_get_read_items(&uartRxBuffer));
             if (!ssi_connected()) {
                 /* STATE CHANGE - Application now waiting for connect */
                 tickrate = 0;
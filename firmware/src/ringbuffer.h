@@ -38,6 +38,7 @@ Notes:
  *******************************************************************************/
 #ifndef RINGBUFFER_H
 #define	RINGBUFFER_H
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -97,6 +98,26 @@ typedef uint32_t ringbuffer_size_t;
 */
 #define RINGBUFFER_MAX_SIZE ((((ringbuffer_size_t) ~((ringbuffer_size_t) 0)) >> 1) + 1)
 
+/* Number of fill level bins in the occupancy histogram (power of 2) */
+#define RINGBUFFER_STATS_BINS   8
+
+/* Occupancy telemetry, kept by a RINGBUFFER_DEFINE buffer once attached.
+*
+* !NOTE!
+* - the writer thread updates every field; read them from elsewhere for
+*   reporting only
+* - histogram[i] counts the writes that left the buffer holding more than
+*   i/RINGBUFFER_STATS_BINS and at most (i+1)/RINGBUFFER_STATS_BINS of its length
+*/
+typedef struct ring_buffer_stats {
+    uint32_t (*clock)(void);        /* time source for last_full, may be NULL */
+    ringbuffer_size_t high_water;   /* most items held at once */
+    uint32_t overruns;              /* items written without room for them */
+    uint32_t fulls;                 /* writes that filled the buffer */
+    uint32_t last_full;             /* clock() at the last of them */
+    uint32_t histogram[RINGBUFFER_STATS_BINS];
+} ringbuffer_stats_t;
+
 typedef struct ring_buffer {
     volatile ringbuffer_size_t writeIdx;
     volatile ringbuffer_size_t readIdx;
@@ -151,6 +172,190 @@ ringbuffer_size_t ringbuffer_advance_write_index(ringbuffer_t *ringbuffer, ringb
 *  Returns number of indices actually advanced (less than itemcount when underrun is encountered) */
 ringbuffer_size_t ringbuffer_advance_read_index(ringbuffer_t *ringbuffer, ringbuffer_size_t itemcount);
 
+/* Account in stats for a write that left fill items in a buffer of len items */
+static inline void __ringbuffer_stats_write(ringbuffer_stats_t *stats, ringbuffer_size_t fill, ringbuffer_size_t len, ringbuffer_size_t bin) {
+    if (fill > stats->high_water)
+        stats->high_water = fill;
+    stats->histogram[bin]++;
+    if (fill == len) {
+        stats->fulls++;
+        if (stats->clock)
+            stats->last_full = stats->clock();
+    }
+}
+
+/*
+* Define a ring buffer type of len items of type, name##_ringbuffer_t, and its
+* functions name##_ringbuffer_*(). With the item size and index mask known at
+* compile time the functions inline to a few instructions, with no multiply,
+* and items move by struct copy (array types included).
+*
+* !NOTE!
+* - len must be a power of 2, up to RINGBUFFER_MAX_SIZE
+* - a zero initialized buffer is empty, so static buffers need no init
+* - as with ringbuffer_t, one reader and one writer may use it concurrently
+* - occupancy telemetry is kept once attached with name##_ringbuffer_attach_stats
+*/
+#define RINGBUFFER_DEFINE(name, type, len)                                      \
+typedef struct { type value; } name##_ringbuffer_item_t;                        \
+typedef struct {                                                                \
+    volatile ringbuffer_size_t writeIdx;                                        \
+    volatile ringbuffer_size_t readIdx;                                         \
+    name##_ringbuffer_item_t data[len];                                         \
+    ringbuffer_stats_t *stats;                                                  \
+} name##_ringbuffer_t;                                                          \
+/* Items as up to two contiguous regions, the second starting at the beginning \
+ * of the buffer when they wrap around and empty otherwise */                   \
+typedef struct {                                                                \
+    type *data[2];                                                              \
+    ringbuffer_size_t itemcount[2];                                             \
+} name##_ringbuffer_write_spans_t;                                              \
+typedef struct {                                                                \
+    const type *data[2];                                                        \
+    ringbuffer_size_t itemcount[2];                                             \
+} name##_ringbuffer_read_spans_t;                                               \
+_Static_assert(((((len) - 1) & (len)) == 0) && ((len) <= RINGBUFFER_MAX_SIZE),  \
+        #name " ring buffer length must be a power of 2");                      \
+_Static_assert(sizeof(name##_ringbuffer_item_t) == sizeof(type),                \
+        #name " ring buffer items must be contiguous for spans");               \
+                                                                                \
+static inline void name##_ringbuffer_reset(name##_ringbuffer_t *ringbuffer) {   \
+    ringbuffer->readIdx = 0;                                                    \
+    ringbuffer->writeIdx = 0;                                                   \
+}                                                                               \
+                                                                                \
+static inline ringbuffer_size_t name##_ringbuffer_get_read_items(name##_ringbuffer_t *ringbuffer) { \
+    return (ringbuffer->writeIdx - ringbuffer->readIdx) & (2U*(len) - 1U);      \
+}                                                                               \
+                                                                                \
+static inline ringbuffer_size_t name##_ringbuffer_get_write_items(name##_ringbuffer_t *ringbuffer) { \
+    return (len) - name##_ringbuffer_get_read_items(ringbuffer);                \
+}                                                                               \
+                                                                                \
+/* Item offset places past the oldest available read item, NULL if none */      \
+static inline const type * name##_ringbuffer_peek(name##_ringbuffer_t *ringbuffer, ringbuffer_size_t offset) { \
+    if (offset >= name##_ringbuffer_get_read_items(ringbuffer))                 \
+        return NULL;                                                            \
+    return &ringbuffer->data[(ringbuffer->readIdx + offset) & ((len) - 1U)].value; \
+}                                                                               \
+                                                                                \
+/* Keep telemetry in stats from now on, clearing it */                         \
+static inline void name##_ringbuffer_attach_stats(name##_ringbuffer_t *ringbuffer, ringbuffer_stats_t *stats, uint32_t (*clock)(void)) { \
+    *stats = (ringbuffer_stats_t) { .clock = clock };                           \
+    ringbuffer->stats = stats;                                                  \
+}                                                                               \
+                                                                                \
+/* Count itemcount items the writer dropped for want of room */                 \
+static inline void name##_ringbuffer_count_overrun(name##_ringbuffer_t *ringbuffer, ringbuffer_size_t itemcount) { \
+    if (ringbuffer->stats)                                                      \
+        ringbuffer->stats->overruns += itemcount;                               \
+}                                                                               \
+                                                                                \
+/* Slot of the next item to write in place, NULL if the buffer is full */      \
+static inline type * name##_ringbuffer_get_write_slot(name##_ringbuffer_t *ringbuffer) { \
+    if (name##_ringbuffer_get_write_items(ringbuffer) == 0)                     \
+        return NULL;                                                            \
+    return &ringbuffer->data[ringbuffer->writeIdx & ((len) - 1U)].value;        \
+}                                                                               \
+                                                                                \
+static inline ringbuffer_size_t name##_ringbuffer_advance_write_index(name##_ringbuffer_t *ringbuffer, ringbuffer_size_t itemcount) { \
+    ringbuffer_size_t availitems = name##_ringbuffer_get_write_items(ringbuffer); \
+    if (itemcount > availitems) {                                               \
+        name##_ringbuffer_count_overrun(ringbuffer, itemcount - availitems);    \
+        itemcount = availitems;                                                 \
+    }                                                                           \
+    __ringbuffer_sync();                                                        \
+    ringbuffer->writeIdx = (ringbuffer->writeIdx + itemcount) & (2U*(len) - 1U); \
+    if (ringbuffer->stats && itemcount) {                                       \
+        ringbuffer_size_t fill = (len) - availitems + itemcount;                \
+        __ringbuffer_stats_write(ringbuffer->stats, fill, (len),                \
+                ((fill - 1U) * RINGBUFFER_STATS_BINS) / (len));                 \
+    }                                                                           \
+    return itemcount;                                                           \
+}                                                                               \
+                                                                                \
+static inline ringbuffer_size_t name##_ringbuffer_advance_read_index(name##_ringbuffer_t *ringbuffer, ringbuffer_size_t itemcount) { \
+    ringbuffer_size_t availitems = name##_ringbuffer_get_read_items(ringbuffer); \
+    if (itemcount > availitems)                                                 \
+        itemcount = availitems;                                                 \
+    __ringbuffer_sync();                                                        \
+    ringbuffer->readIdx = (ringbuffer->readIdx + itemcount) & (2U*(len) - 1U);  \
+    return itemcount;                                                           \
+}                                                                               \
+                                                                                \
+/* Reserve up to itemcount items for writing in place, wrapping included;       \
+ * returns the number reserved, visible to the reader once committed */         \
+static inline ringbuffer_size_t name##_ringbuffer_reserve_write(name##_ringbuffer_t *ringbuffer, ringbuffer_size_t itemcount, name##_ringbuffer_write_spans_t *spans) { \
+    ringbuffer_size_t writeIdx = ringbuffer->writeIdx;                          \
+    ringbuffer_size_t availitems = (len) - ((writeIdx - ringbuffer->readIdx) & (2U*(len) - 1U)); \
+    if (itemcount > availitems)                                                 \
+        itemcount = availitems;                                                 \
+    writeIdx &= (len) - 1U;                                                     \
+    spans->data[0] = &ringbuffer->data[writeIdx].value;                         \
+    spans->data[1] = &ringbuffer->data[0].value;                                \
+    spans->itemcount[0] = ((len) - writeIdx >= itemcount) ? itemcount : (len) - writeIdx; \
+    spans->itemcount[1] = itemcount - spans->itemcount[0];                      \
+    return itemcount;                                                           \
+}                                                                               \
+                                                                                \
+/* Publish the first itemcount items of a reservation */                        \
+static inline ringbuffer_size_t name##_ringbuffer_commit_write(name##_ringbuffer_t *ringbuffer, ringbuffer_size_t itemcount) { \
+    return name##_ringbuffer_advance_write_index(ringbuffer, itemcount);        \
+}                                                                               \
+                                                                                \
+/* Get up to itemcount items starting offset items past the oldest available    \
+ * read item, wrapping included; returns the number of items */                 \
+static inline ringbuffer_size_t name##_ringbuffer_peek_read_spans(name##_ringbuffer_t *ringbuffer, ringbuffer_size_t offset, ringbuffer_size_t itemcount, name##_ringbuffer_read_spans_t *spans) { \
+    ringbuffer_size_t readIdx = ringbuffer->readIdx;                            \
+    ringbuffer_size_t availitems = (ringbuffer->writeIdx - readIdx) & (2U*(len) - 1U); \
+    if (offset > availitems)                                                    \
+        offset = availitems;                                                    \
+    availitems -= offset;                                                       \
+    if (itemcount > availitems)                                                 \
+        itemcount = availitems;                                                 \
+    readIdx = (readIdx + offset) & ((len) - 1U);                                \
+    spans->data[0] = &ringbuffer->data[readIdx].value;                          \
+    spans->data[1] = &ringbuffer->data[0].value;                                \
+    spans->itemcount[0] = ((len) - readIdx >= itemcount) ? itemcount : (len) - readIdx; \
+    spans->itemcount[1] = itemcount - spans->itemcount[0];                      \
+    return itemcount;                                                           \
+}                                                                               \
+                                                                                \
+static inline ringbuffer_size_t name##_ringbuffer_get_read_spans(name##_ringbuffer_t *ringbuffer, ringbuffer_size_t itemcount, name##_ringbuffer_read_spans_t *spans) { \
+    return name##_ringbuffer_peek_read_spans(ringbuffer, 0, itemcount, spans);  \
+}                                                                               \
+                                                                                \
+/* Copy an item in; returns false if the buffer is full */                      \
+static inline bool name##_ringbuffer_push(name##_ringbuffer_t *ringbuffer, const type *item) { \
+    ringbuffer_size_t writeIdx = ringbuffer->writeIdx;                          \
+    ringbuffer_size_t fill = (writeIdx - ringbuffer->readIdx) & (2U*(len) - 1U); \
+    if (fill == (len)) {                                                        \
+        name##_ringbuffer_count_overrun(ringbuffer, 1);                         \
+        return false;                                                           \
+    }                                                                           \
+    ringbuffer->data[writeIdx & ((len) - 1U)] = *(const name##_ringbuffer_item_t *) item; \
+    __ringbuffer_sync();                                                        \
+    ringbuffer->writeIdx = (writeIdx + 1U) & (2U*(len) - 1U);                   \
+    if (ringbuffer->stats)                                                      \
+        __ringbuffer_stats_write(ringbuffer->stats, fill + 1U, (len),           \
+                (fill * RINGBUFFER_STATS_BINS) / (len));                        \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+/* Copy up to itemcount items out; returns the number copied */                \
+static inline ringbuffer_size_t name##_ringbuffer_read(name##_ringbuffer_t *ringbuffer, type *dst, ringbuffer_size_t itemcount) { \
+    ringbuffer_size_t readIdx = ringbuffer->readIdx;                            \
+    ringbuffer_size_t availitems = name##_ringbuffer_get_read_items(ringbuffer); \
+    name##_ringbuffer_item_t *out = (name##_ringbuffer_item_t *) dst;           \
+    if (itemcount > availitems)                                                 \
+        itemcount = availitems;                                                 \
+    for (ringbuffer_size_t i = 0; i < itemcount; i++)                           \
+        out[i] = ringbuffer->data[(readIdx + i) & ((len) - 1U)];                \
+    __ringbuffer_sync();                                                        \
+    ringbuffer->readIdx = (readIdx + itemcount) & (2U*(len) - 1U);              \
+    return itemcount;                                                           \
+}
+
 #ifdef	__cplusplus
 }
 #endif
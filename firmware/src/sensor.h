@@ -40,7 +40,9 @@
 #define	SENSOR_H
 
 #include <stdint.h>
+#include <string.h>
 #include "sensor_config.h"
+#include "ringbuffer.h"
 #if SNSR_TYPE_BMI160
     #include "bmi160.h"
 #elif SNSR_TYPE_ICM42688
@@ -60,6 +62,9 @@
 extern "C" {
 #endif
 
+/* Sample buffer type, snsr_ringbuffer_t, filled by sensor_read_fifo */
+RINGBUFFER_DEFINE(snsr, snsr_dataframe_t, SNSR_BUF_LEN)
+
 struct sensor_device_t {
 #if SNSR_TYPE_BMI160
     struct bmi160_dev device;
@@ -70,6 +75,25 @@ struct sensor_device_t {
     volatile int status;
 };
 
+/* Store the sample time in the timestamp column of frame (no-op if disabled) */
+static inline void snsr_set_timestamp(snsr_data_t *frame, uint32_t timestamp_us) {
+#if SNSR_USE_TIMESTAMP
+    memcpy(&frame[SNSR_NUM_AXES], &timestamp_us, sizeof(timestamp_us));
+#endif
+}
+
+/* Fetch the sample time from the timestamp column of frame */
+static inline uint32_t snsr_get_timestamp(const snsr_data_t *frame) {
+    uint32_t timestamp_us = 0;
+#if SNSR_USE_TIMESTAMP
+    memcpy(&timestamp_us, &frame[SNSR_NUM_AXES], sizeof(timestamp_us));
+#endif
+    return timestamp_us;
+}
+
+/* Called on completion of sensor_read_async, with the result in sensor->status */
+typedef void (*sensor_read_cb_t)(struct sensor_device_t *sensor);
+
 // forward declarations of functions provided elsewhere
 extern uint64_t __attribute__((weak)) snsr_read_timer_ms(void);
 extern uint64_t __attribute__((weak)) snsr_read_timer_us(void);
@@ -80,7 +104,21 @@ int sensor_init(struct sensor_device_t *sensor);
 
 int sensor_set_config(struct sensor_device_t *sensor);
 
-int sensor_read(struct sensor_device_t *sensor, snsr_data_t *ptr);
+/* Start a read of one sample into ptr and return without waiting for the bus
+ * transfer; callback is invoked (possibly from interrupt context) once ptr
+ * has been filled. callback is not invoked if the read could not be started */
+int sensor_read_async(struct sensor_device_t *sensor, snsr_data_t *ptr, sensor_read_cb_t callback);
+
+/* Drain all samples queued in the sensor FIFO directly into ringbuffer;
+ * samples that don't fit are discarded and their count returned in dropped */
+int sensor_read_fifo(struct sensor_device_t *sensor, snsr_ringbuffer_t *ringbuffer, ringbuffer_size_t *dropped);
+
+/* Discard any samples queued in the sensor FIFO */
+int sensor_flush_fifo(struct sensor_device_t *sensor);
+
+/* Read the die temperature in hundredths of a degree Celsius; waits for the
+ * bus, so only call while no other sensor read is in progress */
+int sensor_read_temperature(struct sensor_device_t *sensor, int16_t *centidegrees);
 
 #ifdef	__cplusplus
 }
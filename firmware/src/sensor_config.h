@@ -59,11 +59,17 @@
 #if SNSR_TYPE_BMI160
     #define sensor_init        bmi160_sensor_init
     #define sensor_set_config  bmi160_sensor_set_config
-    #define sensor_read        bmi160_sensor_read
+    #define sensor_read_async  bmi160_sensor_read_async
+    #define sensor_read_fifo   bmi160_sensor_read_fifo
+    #define sensor_flush_fifo  bmi160_sensor_flush_fifo
+    #define sensor_read_temperature bmi160_sensor_read_temperature
 #elif SNSR_TYPE_ICM42688
     #define sensor_init        icm42688_sensor_init
     #define sensor_set_config  icm42688_sensor_set_config
-    #define sensor_read        icm42688_sensor_read
+    #define sensor_read_async  icm42688_sensor_read_async
+    #define sensor_read_fifo   icm42688_sensor_read_fifo
+    #define sensor_flush_fifo  icm42688_sensor_flush_fifo
+    #define sensor_read_temperature icm42688_sensor_read_temperature
 #endif
 
 #ifdef	__cplusplus
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Host side of the COBS framed stream (DATA_STREAMER_FORMAT_COBS).
+
+Every frame is a packet stuffed with COBS (see firmware/src/cobs.h) and ended
+by a zero byte. Packets hold, little endian:
+
+    counter     16 bit rolling frame count; a jump marks dropped frames
+    samples     SNSR_SAMPLES_PER_PACKET frames of 16 bit values
+    crc         CRC-16/CCITT-FALSE of counter and samples
+
+With SNSR_OVERRUN_CONTINUOUS the firmware sends a gap record where it had to
+drop samples, a frame of odd length holding, little endian:
+
+    lost        32 bit count of samples dropped
+    position    8 bit count of samples of the next frame that come before the gap
+    crc         CRC-16/CCITT-FALSE of lost and position
+
+and the CSV gets a "gap,N" line in their place.
+
+A line error can only corrupt the frame it hits: the decoder picks up again at
+the next zero byte and the CRC rejects the damaged frame.
+
+    cobs_decode.py CAPTURE [--columns N] [-o OUT.csv]
+
+CAPTURE is a binary capture of the stream, or a serial port given as PORT@BAUD
+(requires pyserial). --columns is the number of values per sample: 6 for
+accelerometer and gyroscope, plus 2 with SNSR_USE_TIMESTAMP.
+"""
+import argparse
+import csv
+import struct
+import sys
+
+
+def crc16(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    """Unstuff one frame (without its delimiter); returns None if malformed"""
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    """Incremental stream decoder: feed it bytes, get back (counter, samples);
+    samples holds a ('gap', N) entry where the firmware dropped N samples"""
+
+    def __init__(self, columns):
+        self.columns = columns
+        self.buf = bytearray()
+        self.counter = None
+        self.frames = 0
+        self.errors = 0
+        self.dropped = 0
+        self.gap_samples = 0
+        self.gap = None
+
+    def feed(self, data):
+        self.buf += data
+        packets = []
+        *frames, self.buf = self.buf.split(b'\0')
+        for frame in frames:
+            if not frame:
+                continue
+            packet = cobs_decode(frame)
+            if (packet is None or len(packet) < 4
+                    or crc16(packet[:-2]) != struct.unpack_from('<H', packet, len(packet) - 2)[0]):
+                self.errors += 1
+                continue
+            if len(packet) % 2:
+                if len(packet) != 7:
+                    self.errors += 1
+                    continue
+                self.gap = struct.unpack_from('<IB', packet)
+                self.gap_samples += self.gap[0]
+                continue
+            values = (len(packet) - 4) // 2
+            if values <= 0 or values % self.columns:
+                self.errors += 1
+                continue
+            counter, = struct.unpack_from('<H', packet)
+            if self.counter is not None:
+                self.dropped += (counter - self.counter - 1) & 0xFFFF
+            self.counter = counter
+            self.frames += 1
+            flat = struct.unpack_from('<%dh' % values, packet, 2)
+            samples = [flat[i:i + self.columns] for i in range(0, values, self.columns)]
+            if self.gap:
+                lost, position = self.gap
+                samples.insert(min(position, len(samples)), ('gap', lost))
+                self.gap = None
+            packets.append((counter, samples))
+        return packets
+
+
+def open_capture(name):
+    if '@' in name:
+        import serial
+        port, baud = name.rsplit('@', 1)
+        return serial.Serial(port, int(baud), timeout=1)
+    return open(name, 'rb')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('capture', help='binary capture file, or PORT@BAUD')
+    parser.add_argument('--columns', type=int, default=6, help='values per sample')
+    parser.add_argument('-o', '--output', help='CSV file to write (default stdout)')
+    args = parser.parse_args()
+
+    decoder = Decoder(args.columns)
+    out = open(args.output, 'w', newline='') if args.output else sys.stdout
+    writer = csv.writer(out)
+    with open_capture(args.capture) as capture:
+        try:
+            while True:
+                data = capture.read(4096)
+                if not data and not hasattr(capture, 'in_waiting'):
+                    break
+                for counter, samples in decoder.feed(data):
+                    writer.writerows(list(s) if s[0] == 'gap' else [counter] + list(s) for s in samples)
+        except KeyboardInterrupt:
+            pass
+    print('%d frames, %d rejected, %d dropped, %d samples dropped by the firmware'
+          % (decoder.frames, decoder.errors, decoder.dropped, decoder.gap_samples), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
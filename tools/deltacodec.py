@@ -0,0 +1,320 @@
+#!/usr/bin/env python3
+"""Host side of the compressed stream (DATA_STREAMER_FORMAT_COMPRESSED).
+
+Packets and gap records are laid out as described in firmware/src/deltacodec.h
+(gap records are sent with SNSR_OVERRUN_CONTINUOUS). This module
+provides a decoder for the stream and a port of the firmware encoder, and can be
+run as a script:
+
+    deltacodec.py decode CAPTURE [-o OUT.csv]
+        Decode a binary capture of the stream (or a serial port, given as
+        PORT@BAUD, with pyserial installed) into CSV, one frame per line; a
+        "gap,N" line stands where the firmware dropped N samples.
+
+    deltacodec.py bench RECORDING... [--frames N] [--keyframe-interval N]
+        Encode recorded samples the way the firmware would, check that they
+        decode back exactly, and report the compression against the MDV format
+        and the sample rate that buys at a given baud rate. Recordings are
+        captures of the ASCII stream format, or CSV files such as those
+        exported by SensiML Data Capture Lab; non-numeric columns are ignored.
+"""
+import argparse
+import csv
+import sys
+import time
+
+START_OF_FRAME = 0xA6
+GAP_RECORD = 0xA7
+GAP_LEN = 7
+FLAG_KEYFRAME = 0x80
+SEQNUM_MASK = 0x7F
+HEADER_LEN = 6
+TRAILER_LEN = 1
+
+
+def zigzag(value):
+    return ((value << 1) ^ (value >> 15)) & 0xFFFF
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def wrap16(value):
+    """Reduce to a signed 16 bit value, as the firmware's int16_t arithmetic does"""
+    return ((value + 0x8000) & 0xFFFF) - 0x8000
+
+
+def varint(value, out):
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+
+class Encoder:
+    """Port of the firmware encoder, for benchmarking"""
+
+    def __init__(self, columns, keyframe_interval=16):
+        self.columns = columns
+        self.keyframe_interval = keyframe_interval
+        self.countdown = 0
+        self.seqnum = 0
+        self.prev = [0] * columns
+
+    def encode(self, frames):
+        keyframe = self.countdown == 0
+        payload = bytearray()
+        prev = [0] * self.columns if keyframe else self.prev
+        for frame in frames:
+            for j in range(self.columns):
+                varint(zigzag(wrap16(frame[j] - prev[j])), payload)
+            prev = frame
+        header = bytes([START_OF_FRAME, self.seqnum | (FLAG_KEYFRAME if keyframe else 0),
+                        self.columns, len(frames), len(payload) & 0xFF, len(payload) >> 8])
+        check = 0
+        for b in header[1:] + payload:
+            check ^= b
+
+        self.prev = list(frames[-1])
+        self.seqnum = (self.seqnum + 1) & SEQNUM_MASK
+        if keyframe:
+            self.countdown = self.keyframe_interval
+        self.countdown -= 1
+        return header + payload + bytes([check])
+
+
+class Decoder:
+    """Incremental stream decoder.
+
+    Feed it bytes as they arrive; it returns the frames decoded so far, with
+    a ['gap', N] entry where the firmware dropped N samples. Bytes that do not
+    form a valid packet are skipped, and after a lost packet frames are
+    withheld until the next keyframe, so every frame returned is exact.
+    Counters of packets, keyframes and losses are kept for reporting.
+    """
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.prev = None
+        self.seqnum = None
+        self.packets = 0
+        self.keyframes = 0
+        self.lost = 0
+        self.skipped = 0
+        self.dropped = 0
+        self.gap = None
+
+    def feed(self, data):
+        self.buf += data
+        frames = []
+        while True:
+            starts = [i for i in (self.buf.find(START_OF_FRAME), self.buf.find(GAP_RECORD)) if i >= 0]
+            start = min(starts) if starts else -1
+            if start < 0:
+                self.skipped += len(self.buf)
+                self.buf.clear()
+                break
+            if start:
+                self.skipped += start
+                del self.buf[:start]
+            if self.buf[0] == GAP_RECORD:
+                if len(self.buf) < GAP_LEN:
+                    break
+                check = 0
+                for b in self.buf[1:GAP_LEN]:
+                    check ^= b
+                if check:
+                    self.skipped += 1
+                    del self.buf[:1]
+                    continue
+                # Samples lost, and the frames of the next packet ahead of them
+                lost = int.from_bytes(self.buf[1:5], 'little')
+                self.dropped += lost
+                self.gap = (lost, self.buf[5])
+                del self.buf[:GAP_LEN]
+                continue
+            if len(self.buf) < HEADER_LEN:
+                break
+            length = self.buf[4] | (self.buf[5] << 8)
+            values = self.buf[2] * self.buf[3]
+            if not values or not values <= length <= 3 * values:
+                self.skipped += 1
+                del self.buf[:1]
+                continue
+            end = HEADER_LEN + length + TRAILER_LEN
+            if len(self.buf) < end:
+                break
+            packet = self.buf[:end]
+            check = 0
+            for b in packet[1:]:
+                check ^= b
+            decoded = self._decode(packet) if check == 0 else None
+            if decoded is None:
+                # Not a packet after all: resynchronise from the next byte
+                self.skipped += 1
+                del self.buf[:1]
+                continue
+            frames += decoded
+            del self.buf[:end]
+        return frames
+
+    def _decode(self, packet):
+        flags, columns, nframes = packet[1], packet[2], packet[3]
+        keyframe = bool(flags & FLAG_KEYFRAME)
+        seqnum = flags & SEQNUM_MASK
+        values = []
+        value = shift = 0
+        for b in packet[HEADER_LEN:-TRAILER_LEN]:
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                values.append(unzigzag(value))
+                value = shift = 0
+        if shift or columns == 0 or nframes == 0 or len(values) != columns * nframes:
+            return None
+
+        self.packets += 1
+        if self.seqnum is not None and seqnum != (self.seqnum + 1) & SEQNUM_MASK:
+            self.lost += (seqnum - self.seqnum - 1) & SEQNUM_MASK
+            self.prev = None
+        self.seqnum = seqnum
+        if keyframe:
+            self.keyframes += 1
+            self.prev = [0] * columns
+        elif self.prev is None or len(self.prev) != columns:
+            # Joined part way through or lost a packet: wait for a keyframe
+            self.prev = None
+            return []
+
+        frames = []
+        for i in range(nframes):
+            frame = [wrap16(p + d) for p, d in zip(self.prev, values[i * columns:(i + 1) * columns])]
+            frames.append(frame)
+            self.prev = frame
+        if self.gap:
+            lost, position = self.gap
+            frames.insert(min(position, len(frames)), ['gap', lost])
+            self.gap = None
+        return frames
+
+
+def open_capture(name):
+    if '@' in name:
+        import serial
+        port, baud = name.rsplit('@', 1)
+        return serial.Serial(port, int(baud), timeout=1)
+    return open(name, 'rb')
+
+
+def decode_main(args):
+    decoder = Decoder()
+    out = open(args.output, 'w', newline='') if args.output else sys.stdout
+    writer = csv.writer(out)
+    with open_capture(args.capture) as capture:
+        try:
+            while True:
+                data = capture.read(4096)
+                if not data and not hasattr(capture, 'in_waiting'):
+                    break
+                writer.writerows(decoder.feed(data))
+        except KeyboardInterrupt:
+            pass
+    print('%d packets (%d keyframes), %d lost, %d bytes skipped, %d samples dropped by the firmware'
+          % (decoder.packets, decoder.keyframes, decoder.lost, decoder.skipped, decoder.dropped), file=sys.stderr)
+
+
+def load_recording(name):
+    frames = []
+    with open(name, newline='') as f:
+        sample = f.read(4096)
+        f.seek(0)
+        delimiter = ',' if ',' in sample else None
+        for line in f:
+            fields = line.split(delimiter)
+            try:
+                frame = [int(float(x)) for x in fields if x.strip()]
+            except ValueError:
+                # Header, or a line of text printed by the firmware
+                continue
+            if frame:
+                frames.append(frame)
+    if not frames:
+        return []
+
+    # Keep the most common row width and split timestamps as the firmware does
+    width = max(set(len(f) for f in frames), key=[len(f) for f in frames].count)
+    frames = [f for f in frames if len(f) == width]
+    out = []
+    for frame in frames:
+        row = []
+        for x in frame:
+            if -0x8000 <= x < 0x8000:
+                row.append(x)
+            else:
+                x &= 0xFFFFFFFF
+                row += [wrap16(x), wrap16(x >> 16)]
+        out.append(row)
+    return out
+
+
+def bench_main(args):
+    total_frames = total_raw = total_coded = 0
+    for name in args.recordings:
+        frames = load_recording(name)
+        frames = frames[:len(frames) - len(frames) % args.frames]
+        if not frames:
+            print('%s: no frames' % name)
+            continue
+        columns = len(frames[0])
+        encoder = Encoder(columns, args.keyframe_interval)
+        decoder = Decoder()
+
+        t0 = time.perf_counter()
+        stream = b''.join(encoder.encode(frames[i:i + args.frames])
+                          for i in range(0, len(frames), args.frames))
+        t1 = time.perf_counter()
+        decoded = decoder.feed(stream)
+        t2 = time.perf_counter()
+        if decoded != frames:
+            print('%s: round trip FAILED' % name)
+            sys.exit(1)
+
+        # MDV sends each sample as the raw frame between a header and a trailer byte
+        raw = len(frames) * (2 * columns + 2)
+        print('%s: %d frames x %d columns, %d bytes vs %d MDV (%.2fx), %.2f bytes/value, '
+              'encode %.1fus/frame, decode %.1fus/frame'
+              % (name, len(frames), columns, len(stream), raw, raw / len(stream),
+                 len(stream) / (len(frames) * columns),
+                 1e6 * (t1 - t0) / len(frames), 1e6 * (t2 - t1) / len(frames)))
+        total_frames += len(frames)
+        total_raw += raw
+        total_coded += len(stream)
+
+    if total_coded:
+        budget = args.baud * args.load / 1000
+        print('total: %d frames, %.2fx; at %d baud (%d%% load) MDV streams up to %dHz, compressed %dHz'
+              % (total_frames, total_raw / total_coded, args.baud, args.load,
+                 budget * total_frames / total_raw, budget * total_frames / total_coded))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest='command', required=True)
+    p = sub.add_parser('decode', help='decode a capture of the stream to CSV')
+    p.add_argument('capture', help='binary capture file, or PORT@BAUD')
+    p.add_argument('-o', '--output', help='CSV file to write (default stdout)')
+    p.set_defaults(func=decode_main)
+    p = sub.add_parser('bench', help='measure compression over recorded data')
+    p.add_argument('recordings', nargs='+', help='ASCII stream captures or CSV files')
+    p.add_argument('--frames', type=int, default=8, help='samples per packet (SNSR_SAMPLES_PER_PACKET)')
+    p.add_argument('--keyframe-interval', type=int, default=16, help='COMPRESSED_KEYFRAME_INTERVAL')
+    p.add_argument('--baud', type=int, default=115200, help='UART baud rate')
+    p.add_argument('--load', type=int, default=90, help='UART_LINK_MAX_LOAD')
+    p.set_defaults(func=bench_main)
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,155 @@
+/*
+ * Host benchmark of the generic ring buffer (ringbuffer_t) against one defined
+ * with RINGBUFFER_DEFINE, moving sample frames shaped like the firmware's: six
+ * axes and a two word timestamp. Build and run from the repository root with
+ *
+ *     cc -O2 -Ifirmware/src -o ringbuffer_bench tools/ringbuffer_bench.c firmware/src/ringbuffer.c
+ *     ./ringbuffer_bench [FRAMES]
+ *
+ * A desktop CPU multiplies and copies far faster than the Cortex-M0+, so the
+ * absolute figures say little; the ratio between the two buffers is what
+ * carries over.
+ */
+/* clock_gettime and CLOCK_MONOTONIC are POSIX, not ISO C */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ringbuffer.h"
+
+#define BENCH_COLUMNS   8
+#define BENCH_BUF_LEN   128
+#define BENCH_BATCH     16
+
+typedef int16_t bench_frame_t[BENCH_COLUMNS];
+
+RINGBUFFER_DEFINE(bench, bench_frame_t, BENCH_BUF_LEN)
+
+static bench_frame_t generic_data[BENCH_BUF_LEN];
+static ringbuffer_t generic;
+static bench_ringbuffer_t typed;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void frame_fill(bench_frame_t frame, unsigned long n) {
+    for (int j = 0; j < BENCH_COLUMNS; j++)
+        frame[j] = (int16_t) (n * 7 + j);
+}
+
+static unsigned long frame_sum(const bench_frame_t frame) {
+    unsigned long sum = 0;
+    for (int j = 0; j < BENCH_COLUMNS; j++)
+        sum += (uint16_t) frame[j];
+    return sum;
+}
+
+/* Frames written one at a time, as the sensor ISR does, and read in batches */
+static unsigned long bench_generic_copy(unsigned long frames) {
+    bench_frame_t in, out[BENCH_BATCH];
+    unsigned long sum = 0;
+
+    for (unsigned long n = 0; n < frames; ) {
+        for (int i = 0; i < BENCH_BATCH; i++, n++) {
+            frame_fill(in, n);
+            ringbuffer_write(&generic, in, 1);
+        }
+        ringbuffer_size_t count = ringbuffer_read(&generic, out, BENCH_BATCH);
+        for (ringbuffer_size_t i = 0; i < count; i++)
+            sum += frame_sum(out[i]);
+    }
+    return sum;
+}
+
+static unsigned long bench_typed_copy(unsigned long frames) {
+    bench_frame_t in, out[BENCH_BATCH];
+    unsigned long sum = 0;
+
+    for (unsigned long n = 0; n < frames; ) {
+        for (int i = 0; i < BENCH_BATCH; i++, n++) {
+            frame_fill(in, n);
+            bench_ringbuffer_push(&typed, &in);
+        }
+        ringbuffer_size_t count = bench_ringbuffer_read(&typed, out, BENCH_BATCH);
+        for (ringbuffer_size_t i = 0; i < count; i++)
+            sum += frame_sum(out[i]);
+    }
+    return sum;
+}
+
+/* Frames written in place and read by peeking, as the streamers do */
+static unsigned long bench_generic_inplace(unsigned long frames) {
+    unsigned long sum = 0;
+    ringbuffer_size_t count;
+
+    for (unsigned long n = 0; n < frames; ) {
+        for (int i = 0; i < BENCH_BATCH; i++, n++) {
+            bench_frame_t *slot = ringbuffer_get_write_buffer(&generic, &count);
+            frame_fill(*slot, n);
+            ringbuffer_advance_write_index(&generic, 1);
+        }
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            const bench_frame_t *frame = ringbuffer_get_read_buffer(&generic, &count);
+            sum += frame_sum(*frame);
+            ringbuffer_advance_read_index(&generic, 1);
+        }
+    }
+    return sum;
+}
+
+static unsigned long bench_typed_inplace(unsigned long frames) {
+    unsigned long sum = 0;
+
+    for (unsigned long n = 0; n < frames; ) {
+        for (int i = 0; i < BENCH_BATCH; i++, n++) {
+            bench_frame_t *slot = bench_ringbuffer_get_write_slot(&typed);
+            frame_fill(*slot, n);
+            bench_ringbuffer_advance_write_index(&typed, 1);
+        }
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            const bench_frame_t *frame = bench_ringbuffer_peek(&typed, 0);
+            sum += frame_sum(*frame);
+            bench_ringbuffer_advance_read_index(&typed, 1);
+        }
+    }
+    return sum;
+}
+
+static void bench_run(const char *name, unsigned long (*generic_fn)(unsigned long),
+        unsigned long (*typed_fn)(unsigned long), unsigned long frames) {
+    double t0, t1, t2;
+    unsigned long sum_generic, sum_typed;
+
+    ringbuffer_reset(&generic);
+    bench_ringbuffer_reset(&typed);
+    t0 = now_ns();
+    sum_generic = generic_fn(frames);
+    t1 = now_ns();
+    sum_typed = typed_fn(frames);
+    t2 = now_ns();
+
+    if (sum_generic != sum_typed) {
+        printf("%s: results differ\n", name);
+        exit(1);
+    }
+    printf("%-8s generic %.2fns/frame, typed %.2fns/frame (%.2fx)\n", name,
+            (t1 - t0) / frames, (t2 - t1) / frames, (t1 - t0) / (t2 - t1));
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long frames = (argc > 1) ? strtoul(argv[1], NULL, 10) : 10000000UL;
+
+    frames -= frames % BENCH_BATCH;
+    if (frames == 0 || ringbuffer_init(&generic, generic_data, BENCH_BUF_LEN, sizeof(bench_frame_t)))
+        return 1;
+
+    bench_run("copy", bench_generic_copy, bench_typed_copy, frames);
+    bench_run("inplace", bench_generic_inplace, bench_typed_inplace, frames);
+
+    return 0;
+}